@@ -0,0 +1,423 @@
+// Flash Black Box
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Circular log of distance samples and event transitions in the top 64 KB
+// of flash (64 x 1 KB pages), for looking at what the cane saw before a
+// reported incident. Records are delta encoded into a RAM page; a full page
+// is handed to serviceBlackBox(), which erases the flash page and programs
+// it 32 words at a time through the flash write buffer, one step per call.
+// The CPU stalls on flash fetches while the flash is busy (up to ~15 ms for
+// an erase), so the main loop only passes quiet = true between an echo and
+// the next trigger with no haptic pattern playing. Two RAM pages let
+// logging continue while one is written; if both are full, records are
+// dropped and counted.
+//
+// The "blackbox dump" command streams the log oldest page first, plus the
+// pages still in RAM, as CRC checked COBS frames, also from serviceBlackBox()
+// so the loop keeps running. A dump requested part way through a page write
+// starts once that page is in flash, and no page is written while a dump is
+// running, so every flash page is sent whole. Each chunk carries its page's
+// sequence so the decoder can still reject a RAM page that was handed over
+// to flash between chunks. tools/blackbox_decode.c turns it into CSV.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "blackbox.h"
+#include "timebase.h"
+#include "uart0.h"
+#include "crc.h"
+#include "cobs.h"
+
+#define WRITE_BUFFER_WORDS  32
+#define WRITE_STEPS         (BLACKBOX_PAGE_SIZE / (4*WRITE_BUFFER_WORDS))
+#define MAX_RECORD          16
+#define MAX_EVENTS          20
+#define DUMP_WRITE_PAGE     BLACKBOX_PAGES          // RAM page waiting for flash
+#define DUMP_FILL_PAGE      (BLACKBOX_PAGES + 1)    // RAM page being filled
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+uint32_t blackBoxRecords = 0;
+uint32_t blackBoxDropped = 0;
+
+// Word aligned so pages can be programmed a word at a time
+static uint32_t pageBuffer[2][BLACKBOX_PAGE_SIZE/4];
+static uint8_t  fillBuffer = 0;
+static uint16_t fillLength = 0;             // 0 = page not started
+static int8_t   writeBuffer = -1;           // RAM page waiting for flash
+static uint8_t  writeStep;                  // 0 = erase, then WRITE_STEPS programs
+static uint8_t  nextPage;                   // flash page written next (oldest when full)
+static uint32_t nextSequence;
+
+static uint32_t lastTimeMs;
+static uint16_t lastDistance[3];
+static uint8_t  lastStatus[MAX_EVENTS];
+
+static bool     dumpRequested = false;
+static bool     dumping = false;
+static uint8_t  dumpStart;                  // oldest page when the dump started
+static uint8_t  dumpIndex;                  // pages sent, then DUMP_WRITE_PAGE and DUMP_FILL_PAGE
+static uint8_t  dumpChunk;
+static uint8_t  dumpRecord[BB_DUMP_HEADER + BB_DUMP_CHUNK + 2];
+static uint8_t  dumpFrame[COBS_MAX(BB_DUMP_HEADER + BB_DUMP_CHUNK + 2) + 2];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static const uint8_t* getFlashPage(uint8_t page)
+{
+    return (const uint8_t*)(BLACKBOX_BASE + (uint32_t)page*BLACKBOX_PAGE_SIZE);
+}
+
+static uint32_t getPageSequence(const uint8_t* page)
+{
+    return page[0] | (page[1] << 8) | ((uint32_t)page[2] << 16) | ((uint32_t)page[3] << 24);
+}
+
+// Finds the newest page so logging continues after it
+void initBlackBox(void)
+{
+    uint32_t newest = 0;
+    uint8_t page;
+
+    nextPage = 0;
+    nextSequence = 0;
+    for (page = 0; page < BLACKBOX_PAGES; page++)
+    {
+        uint32_t sequence = getPageSequence(getFlashPage(page));
+        if (sequence != 0xFFFFFFFF && (nextSequence == 0 || sequence > newest))
+        {
+            newest = sequence;
+            nextPage = (page + 1) % BLACKBOX_PAGES;
+            nextSequence = sequence + 1;
+        }
+    }
+}
+
+static uint32_t getTimeMs(void)
+{
+    return (uint32_t)(getTimeUs() / 1000);
+}
+
+static uint8_t putVarint(uint8_t* p, uint32_t value)
+{
+    uint8_t length = 0;
+
+    while (value >= 0x80)
+    {
+        p[length++] = value | 0x80;
+        value >>= 7;
+    }
+    p[length++] = value;
+    return length;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+// Closes the page being filled and opens the other one with a SYNC record
+static bool openPage(uint32_t time)
+{
+    uint8_t* page;
+    uint8_t i;
+
+    if (fillLength != 0)
+    {
+        if (writeBuffer >= 0)
+        {
+            return false;                   // both pages busy
+        }
+        writeBuffer = fillBuffer;
+        writeStep = 0;
+        fillBuffer ^= 1;
+    }
+
+    page = (uint8_t*)pageBuffer[fillBuffer];
+    for (i = 0; i < 4; i++)
+    {
+        page[i] = nextSequence >> (8*i);
+    }
+    page[4] = BB_SYNC;
+    for (i = 0; i < 4; i++)
+    {
+        page[5 + i] = time >> (8*i);
+    }
+    for (i = 0; i < 3; i++)
+    {
+        page[9 + 2*i] = lastDistance[i];
+        page[10 + 2*i] = lastDistance[i] >> 8;
+    }
+    fillLength = 15;
+    page[fillLength] = BB_END;
+    nextSequence++;
+    lastTimeMs = time;
+    return true;
+}
+
+static void appendRecord(const uint8_t* record, uint8_t length)
+{
+    uint8_t* page;
+    uint8_t i;
+
+    page = (uint8_t*)pageBuffer[fillBuffer];
+    for (i = 0; i < length; i++)
+    {
+        page[fillLength++] = record[i];
+    }
+    //terminate the partial page for the dump
+    if (fillLength < BLACKBOX_PAGE_SIZE)
+    {
+        page[fillLength] = BB_END;
+    }
+    blackBoxRecords++;
+}
+
+// Makes room for a record, returns the time delta to encode or -1 to drop it
+static int32_t startRecord(uint32_t time)
+{
+    if ((fillLength == 0 || fillLength + MAX_RECORD > BLACKBOX_PAGE_SIZE) && !openPage(time))
+    {
+        blackBoxDropped++;
+        return -1;
+    }
+    return time - lastTimeMs;
+}
+
+void logSample(const uint32_t distance[3])
+{
+    uint8_t record[MAX_RECORD];
+    uint8_t length = 0;
+    uint32_t time = getTimeMs();
+    int32_t dt = startRecord(time);
+    uint8_t i;
+
+    if (dt < 0)
+    {
+        return;
+    }
+    record[length++] = BB_SAMPLE;
+    length += putVarint(&record[length], dt);
+    for (i = 0; i < 3; i++)
+    {
+        uint16_t mm = (distance[i] > 0xFFFF) ? 0xFFFF : distance[i];
+        length += putVarint(&record[length], zigzag((int32_t)mm - lastDistance[i]));
+        lastDistance[i] = mm;
+    }
+    lastTimeMs = time;
+    appendRecord(record, length);
+}
+
+// Logs each event whose status changed since the last call
+void logEvents(const uint8_t status[], uint8_t count)
+{
+    uint8_t record[MAX_RECORD];
+    uint8_t length;
+    uint8_t i;
+
+    for (i = 0; i < count && i < MAX_EVENTS; i++)
+    {
+        uint32_t time;
+        int32_t dt;
+
+        if (status[i] == lastStatus[i])
+        {
+            continue;
+        }
+        time = getTimeMs();
+        if ((dt = startRecord(time)) < 0)
+        {
+            return;
+        }
+        lastStatus[i] = status[i];
+        length = 0;
+        record[length++] = BB_EVENT;
+        length += putVarint(&record[length], dt);
+        record[length++] = i;
+        record[length++] = status[i];
+        lastTimeMs = time;
+        appendRecord(record, length);
+    }
+}
+
+// One erase or one 32 word program of the pending page
+static void writeStepFlash(void)
+{
+    uint32_t address = BLACKBOX_BASE + (uint32_t)nextPage*BLACKBOX_PAGE_SIZE;
+    uint8_t i;
+
+    if (writeStep == 0)
+    {
+        FLASH_FMA_R = address;
+        FLASH_FMC_R = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+        while (FLASH_FMC_R & FLASH_FMC_ERASE);
+    }
+    else
+    {
+        const uint32_t* words = &pageBuffer[writeBuffer][(writeStep - 1)*WRITE_BUFFER_WORDS];
+
+        for (i = 0; i < WRITE_BUFFER_WORDS; i++)
+        {
+            (&FLASH_FWBN_R)[i] = words[i];
+        }
+        FLASH_FMA_R = address + (writeStep - 1)*4*WRITE_BUFFER_WORDS;
+        FLASH_FMC2_R = FLASH_FMC_WRKEY | FLASH_FMC2_WRBUF;
+        while (FLASH_FMC2_R & FLASH_FMC2_WRBUF);
+    }
+
+    if (++writeStep > WRITE_STEPS)
+    {
+        writeBuffer = -1;
+        nextPage = (nextPage + 1) % BLACKBOX_PAGES;
+    }
+}
+
+// Queues the next dump frame if it fits in the TX buffers
+static void dumpStep(void)
+{
+    uint8_t* record = dumpRecord;
+    uint16_t length = 2;
+    uint16_t frameLength;
+    const uint8_t* page = 0;
+    uint16_t used = BLACKBOX_PAGE_SIZE;
+    uint32_t sequence;
+    uint16_t crc;
+    uint16_t i;
+
+    if (getUart0TxFree() < sizeof(dumpFrame))
+    {
+        return;
+    }
+
+    //skip unused flash pages, then the RAM pages that have records
+    while (page == 0 && dumpIndex <= DUMP_FILL_PAGE)
+    {
+        if (dumpIndex < BLACKBOX_PAGES)
+        {
+            page = getFlashPage((dumpStart + dumpIndex) % BLACKBOX_PAGES);
+            if (getPageSequence(page) == 0xFFFFFFFF)
+            {
+                page = 0;
+            }
+        }
+        else if (dumpIndex == DUMP_WRITE_PAGE && writeBuffer >= 0)
+        {
+            page = (const uint8_t*)pageBuffer[writeBuffer];
+        }
+        else if (dumpIndex == DUMP_FILL_PAGE && fillLength != 0)
+        {
+            page = (const uint8_t*)pageBuffer[fillBuffer];
+            used = fillLength + 1;
+        }
+        if (page == 0)
+        {
+            dumpIndex++;
+        }
+    }
+
+    record[0] = 'B';
+    record[1] = (page == 0) ? BB_DUMP_END : dumpChunk;
+    if (page != 0)
+    {
+        sequence = getPageSequence(page);
+        for (i = 0; i < 4; i++)
+        {
+            record[length++] = sequence >> (8*i);
+        }
+        for (i = dumpChunk*BB_DUMP_CHUNK; i < (dumpChunk + 1)*BB_DUMP_CHUNK; i++)
+        {
+            //the unfilled part of the RAM page reads as erased flash
+            record[length++] = (i < used) ? page[i] : 0xFF;
+        }
+    }
+    crc = crc16(CRC16_INIT, record, length);
+    record[length++] = crc;
+    record[length++] = crc >> 8;
+
+    dumpFrame[0] = 0;
+    frameLength = cobsEncode(record, length, &dumpFrame[1]) + 1;
+    dumpFrame[frameLength++] = 0;
+    tryWriteUart0(dumpFrame, frameLength);
+
+    if (page == 0)
+    {
+        dumping = false;
+    }
+    else if (++dumpChunk == BLACKBOX_PAGE_SIZE/BB_DUMP_CHUNK)
+    {
+        dumpChunk = 0;
+        dumpIndex++;
+    }
+}
+
+// Called from the main loop; quiet means the flash may stall the CPU now
+void serviceBlackBox(bool quiet)
+{
+    //pages wait in RAM during a dump, a requested dump waits for a write under way
+    if (writeBuffer >= 0 && quiet && !dumping)
+    {
+        writeStepFlash();
+    }
+    if (dumpRequested && (writeBuffer < 0 || writeStep == 0))
+    {
+        dumpRequested = false;
+        dumpStart = nextPage;
+        dumpIndex = 0;
+        dumpChunk = 0;
+        dumping = true;
+    }
+    if (dumping)
+    {
+        dumpStep();
+    }
+}
+
+void startBlackBoxDump(void)
+{
+    if (!dumping)
+    {
+        dumpRequested = true;
+    }
+}
+
+bool isBlackBoxDumping(void)
+{
+    return dumping || dumpRequested;
+}
+
+// True while a full page is waiting for flash steps from serviceBlackBox
+bool isBlackBoxWritePending(void)
+{
+    return writeBuffer >= 0;
+}
+
+uint8_t getBlackBoxPagesUsed(void)
+{
+    uint8_t used = 0;
+    uint8_t page;
+
+    for (page = 0; page < BLACKBOX_PAGES; page++)
+    {
+        if (getPageSequence(getFlashPage(page)) != 0xFFFFFFFF)
+        {
+            used++;
+        }
+    }
+    return used;
+}
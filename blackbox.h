@@ -0,0 +1,54 @@
+// Flash Black Box
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (page format also used by the host tools)
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+#ifndef BLACKBOX_H_
+#define BLACKBOX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Log region, kept out of FLASH in tm4c123gh6pm.cmd
+#define BLACKBOX_BASE       0x00030000
+#define BLACKBOX_PAGES      64
+#define BLACKBOX_PAGE_SIZE  1024
+
+// Page: u32 sequence (erased = unused), then records until an 0xFF tag.
+// Each page starts with a SYNC record so it decodes on its own. Times are
+// in ms; varints are 7 bits per byte, low first, 0x80 = more.
+#define BB_SAMPLE           1       // varint dt, 3 x zigzag varint distance delta (mm)
+#define BB_EVENT            2       // varint dt, event, status
+#define BB_SYNC             3       // u32 time, 3 x u16 distance (mm)
+#define BB_END              0xFF
+
+// Dump frames (COBS, 0x00 delimited): 'B', chunk, u32 page sequence, 256
+// page bytes, CRC16; chunks 0-3 make a page and must carry the same
+// sequence as its first word, chunk BB_DUMP_END ('B', chunk, CRC16) ends
+// the dump
+#define BB_DUMP_CHUNK       256
+#define BB_DUMP_HEADER      6
+#define BB_DUMP_END         0xFF
+
+extern uint32_t blackBoxRecords;
+extern uint32_t blackBoxDropped;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initBlackBox(void);
+void logSample(const uint32_t distance[3]);
+void logEvents(const uint8_t status[], uint8_t count);
+void serviceBlackBox(bool quiet);
+void startBlackBoxDump(void);
+bool isBlackBoxDumping(void);
+bool isBlackBoxWritePending(void);
+uint8_t getBlackBoxPagesUsed(void);
+
+#endif
@@ -0,0 +1,974 @@
+// Command Line Interface
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Command handlers and the command table. To add a command, write a handler
+// and add its entry to commandTable in name order; argument count and types
+// are checked by dispatchCommand before the handler runs.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "cli.h"
+#include "command.h"
+#include "uart0.h"
+#include "config.h"
+#include "wear.h"
+#include "pattern.h"
+#include "latency.h"
+#include "clock.h"
+#include "timebase.h"
+#include "telemetry.h"
+#include "cobs.h"
+#include "fmt.h"
+#include "display.h"
+#include "blackbox.h"
+#include "power.h"
+#include "sched.h"
+#include "perf.h"
+#include "mem.h"
+
+#define BAUD_CONFIRM_US     2000000 // 2 s for the host to confirm a new baud rate
+#define IMPORT_US           2000000 // 2 s for the host to send a configuration frame
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static bool     baudPending = false;
+static uint32_t baudPrevious;
+static uint64_t baudDeadline;
+static uint8_t  baudAckMatch;
+
+static bool     importPending = false;
+static uint64_t importDeadline;
+static uint16_t importLength;
+static bool     importOverrun;
+static bool     importSynced;
+
+// Too large for the stack, shared by export and import
+static uint8_t  configBlob[CONFIG_BLOB_SIZE];
+static uint8_t  configFrame[COBS_MAX(CONFIG_BLOB_SIZE) + 2];
+
+//-----------------------------------------------------------------------------
+// Command handlers
+//-----------------------------------------------------------------------------
+
+static void cmdHelp(USER_DATA* data);
+
+//reboot command
+static void cmdReboot(USER_DATA* data)
+{
+    flushConfig();
+    NVIC_APINT_R = NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ;
+}
+
+//update event MIN_MM and MAX_MM
+static void cmdEvent(USER_DATA* data)
+{
+    char str[50];
+    int32_t event_num = getFieldInteger(data, 1);
+    int32_t sensor, min_mm, max_mm;
+
+    if (!getFieldRange(data, 2, 0, 2, &sensor) || !getFieldRange(data, 3, 0, 65535, &min_mm)
+        || !getFieldRange(data, 4, 0, 65535, &max_mm))
+    {
+        putsUart0("Invalid event. SENSOR: 0-2  MIN/MAX_DIST_MM: 0-65535\n\n");
+    }
+
+    else if (event_num >=0 && event_num < 16)
+    {
+        writeConfig( (0 + 8*event_num), (uint32_t) sensor );
+        writeConfig( (1 + 8*event_num), (uint32_t) min_mm );
+        writeConfig( (2 + 8*event_num), (uint32_t) max_mm );
+        fmtStr(fmtI32(fmtStr(str, "Distances for EVENT "), event_num, 2), " entered.\n\n");
+        putsUart0(str);
+    }
+
+    else if (event_num >= 16 && event_num < 20)
+    {
+        putsUart0("EVENTS 16-19 Reserved for compound Events (\"and\" command)\n\n");
+    }
+
+    else
+    {
+        putsUart0("Invalid Event number. Valid Events: 0-15\n\n");
+    }
+}
+
+//compound event
+static void cmdAnd(USER_DATA* data)
+{
+    char str[50];
+    int32_t event_num = getFieldInteger(data, 1);
+    int32_t event1 =    getFieldInteger(data, 2);
+    int32_t event2 =    getFieldInteger(data, 3);
+
+    if (event_num < 16)
+    {
+        putsUart0("EVENTS 0-15 Reserved for single Events (\"event\" command)\n\n");
+    }
+
+    else if (event_num > 19)
+    {
+        putsUart0("Invalid Event number. Valid Compound Events: 16-19\n\n");
+    }
+
+    else if (event1 < 0 || event1 > 15 || event2 < 0 || event2 > 15)
+    {
+        putsUart0("Invalid sub-Event number. Valid Events: 0-15\n\n");
+    }
+
+    else
+    {
+        writeConfig( (0 + 8*event_num), (uint32_t) 1 );
+        writeConfig( (1 + 8*event_num), (uint32_t) event1 );
+        writeConfig( (2 + 8*event_num), (uint32_t) event2 );
+        fmtStr(fmtI32(fmtStr(str, "Compound EVENT "), event_num, 2), " entered.\n\n");
+        putsUart0(str);
+    }
+}
+
+//erase event
+static void cmdErase(USER_DATA* data)
+{
+    char str[50];
+    int32_t event_num;
+
+    if (getFieldRange(data, 1, 0, 19, &event_num))
+    {
+        writeConfig( (0 + 8*event_num), EVENT_INACTIVE );
+        fmtStr(fmtI32(fmtStr(str, "EVENT "), event_num, 2), " erased.\n\n");
+        putsUart0(str);
+    }
+
+    else
+    {
+        putsUart0("Invalid Event number. Valid Events: 0-19\n\n");
+    }
+}
+
+// Show reads the committed configuration, so note any staged edits
+static void showStaged()
+{
+    char str[50];
+
+    if (isConfigStaging())
+    {
+        fmtStr(fmtU32(str, getStagedChanges(), 0), " staged change(s) not shown until commit.\n\n");
+        putsUart0(str);
+    }
+}
+
+static void showEvents()
+{
+    char str[96];                                // longest line is 88 bytes with full-range imported values
+    char* p;
+    int32_t i;
+
+    putsUart0("\nEVENT LIST\n");
+    for(i = 0; i < 16; i++)
+    {
+        p = fmtI32(fmtStr(str, "EVENT "), i, 2);
+        p = fmtI32(fmtStr(p, "  SENSOR "), readConfig( 0+8*i ), 2);
+        p = fmtU32(fmtStr(p, "  Min Distance: "), readConfig( 1+8*i ), 4);
+        p = fmtU32(fmtStr(p, " mm  Max Distance: "), readConfig( 2+8*i ), 4);
+        fmtStr(p, " mm\n");
+        putsUart0(str);
+    }
+    putsUart0("\n");
+
+    putsUart0("COMPOUND EVENTS\n");
+    for(i = 16; i < 20; i++)
+    {
+        p = fmtI32(fmtStr(str, "EVENT "), i, 2);
+        p = fmtI32(fmtStr(p, "  ACTIVE "), readConfig( 0+8*i ), 2);
+        p = fmtU32(fmtStr(p, "  EVENT "), readConfig( 1+8*i ), 2);
+        p = fmtU32(fmtStr(p, " AND EVENT "), readConfig( 2+8*i ), 2);
+        fmtStr(p, "\n");
+        putsUart0(str);
+    }
+    putsUart0("\n");
+}
+
+static void showPatterns()
+{
+    char str[80];
+    char* p;
+    int32_t i;
+
+    putsUart0("\nPATTERN LIST\n");
+    for(i = 0; i < 20; i++)
+    {
+        p = fmtI32(fmtStr(str, "EVENT "), i, 2);
+        p = fmtU32(fmtStr(p, "  Haptics: "), readConfig( 3+8*i ), 1);
+        p = fmtU32(fmtStr(p, " (on = 1/off = 0)  PWM: "), readConfig( 7+8*i ), 3);
+        fmtStr(p, "%  ");
+        putsUart0(str);
+        p = fmtU32(fmtStr(str, "Beat Count: "), readConfig( 4+8*i ), 2);
+        p = fmtU32(fmtStr(p, "  Time on: "), readConfig( 5+8*i ), 4);
+        p = fmtU32(fmtStr(p, " ms  Time off: "), readConfig( 6+8*i ), 4);
+        fmtStr(p, " ms  ");
+        putsUart0(str);
+        p = fmtU32(fmtStr(str, "Pattern: "), getEventPatternId(i), 2);
+        fmtStr(fmtStr(fmtStr(p, " ("), eventPattern[i]->name), ")\n");
+        putsUart0(str);
+    }
+    putsUart0("\n");
+}
+
+static void showLibrary()
+{
+    char str[60];
+    char* p;
+    uint8_t i;
+
+    putsUart0("\nPATTERN LIBRARY\n");
+    for(i = 1; i < getPatternCount(); i++)
+    {
+        const PATTERN* pattern = getLibraryPattern(i);
+
+        p = fmtU32(fmtStr(str, "PATTERN "), i, 2);
+        p = fmtStrPad(fmtStr(p, "  "), pattern->name, 10);
+        p = fmtU32(fmtStr(p, " Steps: "), pattern->stepCount, 2);
+        p = fmtU32(fmtStr(p, "  Repeat: "), pattern->repeat, 2);
+        fmtStr(p, "\n");
+        putsUart0(str);
+    }
+    putsUart0("\n");
+}
+
+static void showCache()
+{
+    char str[80];
+    char* p;
+    uint8_t i;
+
+    const char* status[4] = { "loaded", "migrated", "recovered", "default profile" };
+
+    putsUart0("\nEEPROM CACHE\n");
+    fmtStr(fmtStr(fmtStr(str, "Configuration: "), status[configStatus]), "\n");
+    putsUart0(str);
+    p = fmtU32(fmtStr(str, "Writes: "), configWrites, 0);
+    p = fmtU32(fmtStr(p, "  Saved: "), configWritesSaved, 0);
+    p = fmtU32(fmtStr(p, "  Pending: "), getConfigPending(), 0);
+    fmtStr(fmtU32(fmtStr(p, "  Moves: "), wearMoves, 0), "\n");
+    putsUart0(str);
+    for (i = 0; i < WEAR_BLOCKS; i++)
+    {
+        p = fmtU32(fmtStr(str, "BLOCK "), i, 2);
+        p = fmtU32(fmtStr(p, " -> "), getWearBlock(i), 2);
+        fmtStr(fmtU32(fmtStr(p, "  Writes: "), getWearCount(getWearBlock(i)), 0), "\n");
+        putsUart0(str);
+    }
+    putsUart0("\n");
+}
+
+// CPU load and wake count since the previous "show power"
+static void showPower()
+{
+    char str[60];
+    char* p;
+    uint32_t wakes, windowMs;
+    uint16_t load = getCpuLoad(&wakes, &windowMs);
+
+    putsUart0("\nPOWER\n");
+    p = fmtU32(fmtStr(str, "CPU load: "), load / 10, 0);
+    p = fmtU32(fmtStr(p, "."), load % 10, 0);
+    p = fmtU32(fmtStr(p, "%  Wakes: "), wakes, 0);
+    fmtStr(fmtU32(fmtStr(p, "  Window: "), windowMs, 0), " ms\n");
+    putsUart0(str);
+    fmtStr(fmtU32(fmtStr(str, "Total wakes: "), powerWakes, 0), "\n\n");
+    putsUart0(str);
+}
+
+// Run count, execution time and deadline misses of each scheduler task
+static void showTasks()
+{
+    char str[80];
+    char* p;
+    uint8_t i;
+
+    putsUart0("\nTASK            Runs  Avg us  Max us  Deadline  Misses\n");
+    for (i = 0; i < getTaskCount(); i++)
+    {
+        const TASK* task = getTask(i);
+        uint32_t avgUs = (task->runs == 0) ? 0 : (uint32_t)(task->totalCycles / task->runs / CYCLES_PER_US);
+
+        p = fmtStrPad(str, task->name, 10);
+        p = fmtU32(p, task->runs, 10);
+        p = fmtU32(p, avgUs, 8);
+        p = fmtU32(p, task->maxUs, 8);
+        p = fmtU32(p, task->deadlineUs, 10);
+        fmtStr(fmtU32(p, task->misses, 8), "\n");
+        putsUart0(str);
+    }
+    putsUart0("\n");
+}
+
+// UART0 rate and RX bytes lost to a full ring since boot
+static void showUart()
+{
+    char str[80];
+    char* p;
+
+    putsUart0("\nUART0\n");
+    p = fmtU32(fmtStr(str, "Baud: "), uart0BaudRate, 0);
+    p = fmtU32(fmtStr(p, "  RX overflows: "), uart0RxOverflows, 0);
+    fmtStr(fmtU32(fmtStr(p, "  TX free: "), getUart0TxFree(), 0), "\n\n");
+    putsUart0(str);
+}
+
+//show events, patterns, library, cache, power, tasks or uart
+static void cmdShow(USER_DATA* data)
+{
+    if (isFieldString(data, 1, "events"))
+    {
+        showEvents();
+    }
+
+    else if (isFieldString(data, 1, "patterns"))
+    {
+        showPatterns();
+    }
+
+    else if (isFieldString(data, 1, "library"))
+    {
+        showLibrary();
+    }
+
+    else if (isFieldString(data, 1, "cache"))
+    {
+        showCache();
+    }
+
+    else if (isFieldString(data, 1, "power"))
+    {
+        showPower();
+    }
+
+    else if (isFieldString(data, 1, "tasks"))
+    {
+        showTasks();
+    }
+
+    else if (isFieldString(data, 1, "uart"))
+    {
+        showUart();
+    }
+
+    else
+    {
+        putsUart0("Usage: show events/patterns/library/cache/power/tasks/uart\n\n");
+        return;
+    }
+    showStaged();
+}
+
+//update haptic
+static void cmdHaptic(USER_DATA* data)
+{
+    int32_t event_num;
+
+    if (!getFieldRange(data, 1, 0, 19, &event_num))
+    {
+        putsUart0("Invalid Event number. Valid Events: 0-19\n\n");
+    }
+
+    //if haptic set to "on"
+    else if (isFieldString(data, 2, "on"))
+    {
+        writeConfig( (3 + 8*event_num), (uint32_t) 1 );
+        putsUart0("Haptic is on.\n\n");
+    }
+
+    else if (isFieldString(data, 2, "off"))
+    {
+        writeConfig( (3 + 8*event_num), (uint32_t) 0 );
+        putsUart0("Haptic is off.\n\n");
+    }
+}
+
+//update pattern
+static void cmdPattern(USER_DATA* data)
+{
+    char str[50];
+    int32_t event_num, pwm, beats, ms_on_time, ms_off_time;
+
+    if (!getFieldRange(data, 2, 0, 100, &pwm) || !getFieldRange(data, 3, 0, 255, &beats)
+        || !getFieldRange(data, 4, 0, 65535, &ms_on_time) || !getFieldRange(data, 5, 0, 65535, &ms_off_time))
+    {
+        putsUart0("Invalid pattern. PWM: 0-100  BEATS: 0-255  ON/OFF_TIME: 0-65535 ms\n");
+    }
+
+    else if (getFieldRange(data, 1, 0, 19, &event_num))
+    {
+        writeConfig( (7 + 8*event_num), (uint32_t) pwm );
+        writeConfig( (4 + 8*event_num), (uint32_t) beats );
+        writeConfig( (5 + 8*event_num), (uint32_t) ms_on_time );
+        writeConfig( (6 + 8*event_num), (uint32_t) ms_off_time );
+        selectEventPattern(event_num, PATTERN_LEGACY);
+        fmtStr(fmtI32(fmtStr(str, "Patterns for EVENT "), event_num, 2), " entered.\n");
+        putsUart0(str);
+    }
+
+    else
+    {
+        putsUart0("Invalid Event number. Valid Events: 0-19\n");
+    }
+
+    putsUart0("\n");
+}
+
+//select library pattern
+static void cmdUse(USER_DATA* data)
+{
+    char str[50];
+    int32_t event_num, pattern_id;
+
+    if (getFieldRange(data, 1, 0, 19, &event_num) && getFieldRange(data, 2, 0, 255, &pattern_id)
+        && selectEventPattern(event_num, pattern_id))
+    {
+        fmtStr(fmtI32(fmtStr(fmtI32(fmtStr(str, "EVENT "), event_num, 2), " uses pattern "), pattern_id, 2), ".\n\n");
+        putsUart0(str);
+    }
+
+    else
+    {
+        putsUart0("Invalid Event or Pattern. See show library\n\n");
+    }
+}
+
+//echo-to-vibration latency histograms and capture latency
+static void cmdLatency(USER_DATA* data)
+{
+    char str[50];
+
+    if (isFieldString(data, 1, "reset"))
+    {
+        resetLatency();
+        putsUart0("Latency counters reset.\n\n");
+    }
+
+    else
+    {
+        const char* title[2] = { "ECHO TO DECISION", "ECHO TO PWM" };
+        uint8_t i, b;
+        for (i = 0; i < 2; i++)
+        {
+            LATENCY_STATS* stats = &latencyStats[i];
+
+            fmtStr(fmtU32(fmtStr(fmtStr(fmtStr(str, "\n"), title[i]), "  ("), stats->count, 0), " samples)\n");
+            putsUart0(str);
+            if (stats->count == 0)
+            {
+                continue;
+            }
+            fmtStr(fmtU32(fmtStr(fmtU32(fmtStr(str, "Min: "), stats->minUs, 0), " us  Max: "), stats->maxUs, 0), " us\n");
+            putsUart0(str);
+            for (b = 0; b < LATENCY_BINS; b++)
+            {
+                if (stats->bin[b] != 0)
+                {
+                    fmtStr(fmtU32(fmtStr(fmtU32(fmtStr(str, "  < "), (uint32_t)1 << b, 8), " us: "), stats->bin[b], 0), "\n");
+                    putsUart0(str);
+                }
+            }
+        }
+
+        putsUart0("\nCAPTURE EDGE TO ISR (worst case)\n");
+        for (i = 0; i < 3; i++)
+        {
+            fmtStr(fmtU32(fmtStr(fmtU32(fmtStr(str, "Sensor "), i, 0), ": "), captureLatencyMax[i] * 1000 / CYCLES_PER_US, 0), " ns\n");
+            putsUart0(str);
+        }
+        putsUart0("\n");
+    }
+}
+
+//binary telemetry stream
+static void cmdTelemetry(USER_DATA* data)
+{
+    char str[50];
+
+    if (data->fieldCount > 1)
+    {
+        if (isFieldString(data, 1, "on"))
+        {
+            putsUart0("Telemetry on.\n\n");
+            setTelemetry(true);
+        }
+        else if (isFieldString(data, 1, "off"))
+        {
+            setTelemetry(false);
+            putsUart0("Telemetry off.\n\n");
+        }
+    }
+
+    else
+    {
+        fmtStr(fmtU32(fmtStr(fmtU32(fmtStr(str, "Records sent: "), telemetrySent, 0), "  Dropped: "), telemetryDropped, 0), "\n\n");
+        putsUart0(str);
+    }
+}
+
+//cycle counts per ISR and scheduler task
+static void cmdPerf(USER_DATA* data)
+{
+    char str[80];
+    char* p;
+    uint8_t i;
+
+    if (isFieldString(data, 1, "on"))
+    {
+        perfEnabled = true;
+        putsUart0("Profiling on.\n\n");
+    }
+
+    else if (isFieldString(data, 1, "off"))
+    {
+        perfEnabled = false;
+        putsUart0("Profiling off.\n\n");
+    }
+
+    else if (isFieldString(data, 1, "reset"))
+    {
+        resetPerf();
+        putsUart0("Profile counters reset.\n\n");
+    }
+
+    else
+    {
+        putsUart0(perfEnabled ? "\nPROFILE (on, cycles)\n" : "\nPROFILE (off, cycles)\n");
+        putsUart0("PROBE          Count     Min     Avg     Max\n");
+        for (i = 0; i < PERF_PROBES; i++)
+        {
+            PERF_STATS* stats = &perfStats[i];
+
+            if (getPerfName(i) == 0 || stats->count == 0)
+            {
+                continue;
+            }
+            p = fmtStrPad(str, getPerfName(i), 10);
+            p = fmtU32(p, stats->count, 10);
+            p = fmtU32(p, stats->minCycles, 8);
+            p = fmtU32(p, (uint32_t)(stats->totalCycles / stats->count), 8);
+            fmtStr(fmtU32(p, stats->maxCycles, 8), "\n");
+            putsUart0(str);
+        }
+        putsUart0("\n");
+    }
+}
+
+//stack high-water mark and section sizes
+static void cmdMem(USER_DATA* data)
+{
+    char str[50];
+    MEM_USAGE usage;
+
+    getMemUsage(&usage);
+    putsUart0("\nMEMORY (bytes)\n");
+    fmtStr(fmtU32(fmtStr(str, ".data:     "), usage.dataBytes, 6), "\n");
+    putsUart0(str);
+    fmtStr(fmtU32(fmtStr(str, ".bss:      "), usage.bssBytes, 6), "\n");
+    putsUart0(str);
+    fmtStr(fmtU32(fmtStr(str, "Heap:      "), usage.heapBytes, 6), "\n");
+    putsUart0(str);
+    fmtStr(fmtU32(fmtStr(fmtU32(fmtStr(str, "Stack:     "), usage.stackUsed, 6), " of "), usage.stackBytes, 0), " used (high-water)\n");
+    putsUart0(str);
+    fmtStr(fmtU32(fmtStr(fmtU32(fmtStr(str, "SRAM free: "), usage.sramFree, 6), " of "), SRAM_SIZE, 0), "\n");
+    putsUart0(str);
+    putsUart0(isStackGuardIntact() ? "Stack guard intact.\n\n" : "Stack guard overwritten, stack is too small!\n\n");
+}
+
+//baud rate negotiation
+static void cmdBaud(USER_DATA* data)
+{
+    char str[50];
+    uint32_t divisor;
+    bool highSpeed;
+
+    if (data->fieldCount > 1)
+    {
+        int32_t rate = 0;
+        int32_t error = INT32_MAX;
+
+        if (getFieldRange(data, 1, 1, INT32_MAX, &rate))
+        {
+            error = getUart0BaudDivisor(rate, SYSTEM_CLOCK_HZ, &divisor, &highSpeed);
+        }
+
+        if (error > UART_MAX_BAUD_ERROR_PPM || error < -UART_MAX_BAUD_ERROR_PPM)
+        {
+            putsUart0("BAUD ERR unsupported rate\n\n");
+        }
+
+        else
+        {
+            fmtStr(fmtI32(fmtStr(str, "BAUD "), rate, 0), " OK\n");
+            putsUart0(str);
+            flushUart0();
+            baudPrevious = uart0BaudRate;
+            setUart0BaudRate(rate, SYSTEM_CLOCK_HZ);
+            baudDeadline = getDeadline(BAUD_CONFIRM_US);
+            baudAckMatch = 0;
+            baudPending = true;
+        }
+    }
+
+    else
+    {
+        int32_t error = getUart0BaudDivisor(uart0BaudRate, SYSTEM_CLOCK_HZ, &divisor, &highSpeed);
+        fmtStr(fmtI32(fmtStr(fmtU32(fmtStr(str, "Baud: "), uart0BaudRate, 0), "  Error: "), error, 0), " ppm\n\n");
+        putsUart0(str);
+    }
+}
+
+//start a configuration transaction
+static void cmdBegin(USER_DATA* data)
+{
+    if (isConfigStaging())
+    {
+        putsUart0("Transaction already open. Use commit or abort.\n\n");
+    }
+
+    else
+    {
+        beginConfig();
+        putsUart0("Transaction open. Changes are staged until commit.\n\n");
+    }
+}
+
+//validate and write the staged configuration
+static void cmdCommit(USER_DATA* data)
+{
+    char str[50];
+    uint8_t changes = getStagedChanges();
+    int8_t badEvent;
+
+    switch (commitConfig(&badEvent))
+    {
+    case CONFIG_OK:
+        fmtStr(fmtU32(fmtStr(str, "Committed "), changes, 0), " word(s).\n\n");
+        putsUart0(str);
+        break;
+    case CONFIG_INVALID:
+        fmtStr(fmtI32(fmtStr(str, "EVENT "), badEvent, 2), " is invalid. Nothing written.\n\n");
+        putsUart0(str);
+        break;
+    default:
+        putsUart0("No transaction open. Use begin first.\n\n");
+        break;
+    }
+}
+
+//discard the staged configuration
+static void cmdAbort(USER_DATA* data)
+{
+    if (isConfigStaging())
+    {
+        abortConfig();
+        putsUart0("Staged changes discarded.\n\n");
+    }
+
+    else
+    {
+        putsUart0("No transaction open.\n\n");
+    }
+}
+
+//send the configuration as one COBS framed blob
+static void cmdExport(USER_DATA* data)
+{
+    uint16_t length = exportConfig(configBlob);
+    uint16_t frameLength;
+
+    putsUart0("EXPORT\n");
+    configFrame[0] = 0;
+    frameLength = cobsEncode(configBlob, length, &configFrame[1]) + 1;
+    configFrame[frameLength++] = 0;
+    flushUart0();
+    tryWriteUart0(configFrame, frameLength);
+    putsUart0("\n");
+}
+
+//receive a configuration blob, see serviceImport
+static void cmdImport(USER_DATA* data)
+{
+    importLength = 0;
+    importOverrun = false;
+    importSynced = false;
+    importDeadline = getDeadline(IMPORT_US);
+    importPending = true;
+    putsUart0("IMPORT READY\n");
+}
+
+//flash black box status and dump
+static void cmdBlackBox(USER_DATA* data)
+{
+    char str[80];
+    char* p;
+
+    if (isFieldString(data, 1, "dump"))
+    {
+        putsUart0("BLACKBOX DUMP\n");
+        startBlackBoxDump();
+    }
+
+    else
+    {
+        p = fmtU32(fmtStr(str, "Pages used: "), getBlackBoxPagesUsed(), 0);
+        p = fmtU32(fmtStr(p, "/64  Records: "), blackBoxRecords, 0);
+        fmtStr(fmtU32(fmtStr(p, "  Dropped: "), blackBoxDropped, 0), "\n\n");
+        putsUart0(str);
+    }
+}
+
+//live display subscription, serviced from the main loop
+static void cmdDisplay(USER_DATA* data)
+{
+    char str[60];
+    uint32_t skipped;
+    int32_t period = DISPLAY_DEFAULT_MS;
+    int32_t mask = -1;
+    uint8_t what = 0;
+
+    if (data->fieldCount == 1)
+    {
+        what = isDisplayOn() ? 0 : DISPLAY_SENSORS;
+    }
+    else if (isFieldString(data, 1, "sensors"))
+    {
+        what = DISPLAY_SENSORS;
+    }
+    else if (isFieldString(data, 1, "events"))
+    {
+        what = DISPLAY_EVENTS;
+    }
+    else if (isFieldString(data, 1, "all"))
+    {
+        what = DISPLAY_SENSORS | DISPLAY_EVENTS;
+    }
+    else if (!isFieldString(data, 1, "off"))
+    {
+        putsUart0("Usage: display [sensors/events/all/off] [PERIOD_MS] [MASK]\n\n");
+        return;
+    }
+
+    if ((data->fieldCount > 2 && !getFieldRange(data, 2, DISPLAY_MIN_MS, DISPLAY_MAX_MS, &period))
+        || (data->fieldCount > 3 && !getFieldRange(data, 3, 1, 0xFFFFF, &mask)))
+    {
+        putsUart0("Invalid display. PERIOD_MS: 10-60000  MASK: bit N selects sensor/event N\n\n");
+        return;
+    }
+
+    //setDisplay() clears the count, so read it first
+    skipped = displaySkipped;
+    setDisplay(what, period, mask);
+    if (what == 0)
+    {
+        fmtStr(fmtU32(fmtStr(str, "Display off. Skipped updates: "), skipped, 0), "\n\n");
+        putsUart0(str);
+    }
+    else
+    {
+        fmtStr(fmtU32(fmtStr(str, "Display every "), period, 0), " ms. Type display off to stop.\n\n");
+        putsUart0(str);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Command table (sorted by name)
+//-----------------------------------------------------------------------------
+
+static const COMMAND commandTable[] =
+{
+    { "abort",     0, "",      cmdAbort,     "(discard staged changes)" },
+    { "and",       3, "nnn",   cmdAnd,       "EVENT EVENT1 EVENT2" },
+    { "baud",      0, "n",     cmdBaud,      "[RATE] (confirm with ack within 2 s)" },
+    { "begin",     0, "",      cmdBegin,     "(stage changes until commit)" },
+    { "blackbox",  0, "a",     cmdBlackBox,  "[dump] (see tools/blackbox_decode)" },
+    { "commit",    0, "",      cmdCommit,    "(validate and write staged changes)" },
+    { "display",   0, "ann",   cmdDisplay,   "[sensors/events/all/off] [PERIOD_MS] [MASK]" },
+    { "erase",     1, "n",     cmdErase,     "EVENT" },
+    { "event",     4, "nnnn",  cmdEvent,     "EVENT SENSOR MIN_DIST_MM MAX_DIST_MM" },
+    { "export",    0, "",      cmdExport,    "(binary configuration, see tools/provision)" },
+    { "haptic",    2, "na",    cmdHaptic,    "EVENT on/off" },
+    { "help",      0, "",      cmdHelp,      "(no params)" },
+    { "import",    0, "",      cmdImport,    "(binary configuration, see tools/provision)" },
+    { "latency",   0, "a",     cmdLatency,   "[reset]" },
+    { "mem",       0, "",      cmdMem,       "(stack high-water and RAM usage)" },
+    { "pattern",   5, "nnnnn", cmdPattern,   "EVENT PWM BEATS ON_TIME OFF_TIME" },
+    { "perf",      0, "a",     cmdPerf,      "[on/off/reset]" },
+    { "reboot",    0, "",      cmdReboot,    "(no params)" },
+    { "show",      1, "a",     cmdShow,      "events/patterns/library/cache/power/tasks/uart" },
+    { "telemetry", 0, "a",     cmdTelemetry, "[on/off]" },
+    { "use",       2, "nn",    cmdUse,       "EVENT PATTERN_ID (0 = own pattern)" },
+};
+
+#define COMMAND_COUNT (sizeof(commandTable)/sizeof(COMMAND))
+
+static void cmdHelp(USER_DATA* data)
+{
+    char str[80];
+    uint8_t i;
+
+    for (i = 0; i < COMMAND_COUNT; i++)
+    {
+        fmtStr(fmtStr(fmtStrPad(str, commandTable[i].name, 14), commandTable[i].help), "\n");
+        putsUart0(str);
+    }
+    putsUart0("\n");
+}
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void processCommand(USER_DATA* data)
+{
+    switch (dispatchCommand(commandTable, COMMAND_COUNT, data))
+    {
+    case CMD_UNKNOWN:
+        putsUart0("Unknown command. Type help for a list.\n\n");
+        break;
+    case CMD_ARG_COUNT:
+        putsUart0("Wrong number of arguments. Type help for usage.\n\n");
+        break;
+    case CMD_ARG_TYPE:
+        putsUart0("Wrong argument type. Type help for usage.\n\n");
+        break;
+    }
+}
+
+// Waits for "ack" at a newly negotiated baud rate without blocking,
+// reverting to the previous rate if it does not arrive in time.
+// Returns true while the negotiation is still open.
+bool serviceBaudNegotiation()
+{
+    const char ack[] = "ack";
+    char c;
+
+    if (!baudPending)
+    {
+        return false;
+    }
+
+    while (tryGetcUart0(&c))
+    {
+        if (c == ack[baudAckMatch])
+        {
+            baudAckMatch++;
+            if (baudAckMatch == 3)
+            {
+                baudPending = false;
+                putsUart0("BAUD CONFIRMED\n\n");
+                return false;
+            }
+        }
+        else
+        {
+            baudAckMatch = (c == ack[0]);
+        }
+    }
+
+    if (isDeadlinePassed(baudDeadline))
+    {
+        setUart0BaudRate(baudPrevious, SYSTEM_CLOCK_HZ);
+        baudPending = false;
+        putsUart0("BAUD REVERTED\n\n");
+    }
+    return baudPending;
+}
+
+static void finishImport()
+{
+    char str[50];
+    uint16_t length = 0;
+    int8_t badEvent;
+
+    importPending = false;
+    if (!importOverrun)
+    {
+        length = cobsDecode(configFrame, importLength, configBlob);
+    }
+
+    switch (importConfig(configBlob, length, &badEvent))
+    {
+    case CONFIG_OK:
+        putsUart0(isConfigStaging() ? "IMPORT OK staged\n\n" : "IMPORT OK\n\n");
+        break;
+    case CONFIG_INVALID:
+        fmtStr(fmtI32(fmtStr(str, "IMPORT ERR event "), badEvent, 0), " invalid\n\n");
+        putsUart0(str);
+        break;
+    default:
+        putsUart0("IMPORT ERR bad frame\n\n");
+        break;
+    }
+}
+
+// Collects the frame following "import" without blocking. Anything before
+// the frame's leading 0x00 (line endings from the command) is discarded.
+// Returns true while the import is still open.
+bool serviceImport()
+{
+    char c;
+
+    if (!importPending)
+    {
+        return false;
+    }
+
+    while (tryGetcUart0(&c))
+    {
+        if (c != 0)
+        {
+            if (!importSynced)
+            {
+                continue;
+            }
+            if (importLength < sizeof(configFrame))
+            {
+                configFrame[importLength++] = c;
+            }
+            else
+            {
+                importOverrun = true;
+            }
+        }
+        else if (importLength != 0)
+        {
+            finishImport();
+            return false;
+        }
+        else
+        {
+            importSynced = true;
+        }
+    }
+
+    if (isDeadlinePassed(importDeadline))
+    {
+        importPending = false;
+        putsUart0("IMPORT ERR timeout\n\n");
+    }
+    return importPending;
+}
+
+// True while a baud change waits for its ack or an import for its frame
+bool isCliTransferPending()
+{
+    return baudPending || importPending;
+}
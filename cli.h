@@ -0,0 +1,26 @@
+// Command Line Interface
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+#ifndef CLI_H_
+#define CLI_H_
+
+#include <stdbool.h>
+#include "parse.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void processCommand(USER_DATA* data);
+bool serviceBaudNegotiation();
+bool serviceImport();
+bool isCliTransferPending();
+
+#endif
@@ -7,7 +7,7 @@
 
 // Target Platform: EK-TM4C123GXL
 // Target uC:       TM4C123GH6PM
-// System Clock:    -
+// System Clock:    16, 40, 50 or 80 MHz (SYSTEM_CLOCK_MHZ)
 
 // Hardware configuration:
 // 16 MHz external crystal oscillator
@@ -28,9 +28,20 @@
 // Subroutines
 //-----------------------------------------------------------------------------
 
-// Initialize system clock to 40 MHz using PLL and 16 MHz crystal oscillator
-void initSystemClockTo40Mhz(void)
+// Initialize system clock to SYSTEM_CLOCK_MHZ from the 16 MHz crystal oscillator
+void initSystemClock(void)
 {
-    // Configure HW to work with 16 MHz XTAL, PLL enabled, sysdivider of 5, creating system clock of 40 MHz
-    SYSCTL_RCC_R = SYSCTL_RCC_XTAL_16MHZ | SYSCTL_RCC_OSCSRC_MAIN | SYSCTL_RCC_USESYSDIV | (4 << SYSCTL_RCC_SYSDIV_S);
+#if CLOCK_USE_PLL
+    // Configure HW to work with 16 MHz XTAL and the 400 MHz PLL output divided by CLOCK_PLL_DIVISOR
+    // RCC2 is needed for the 7-bit divider (SYSDIV2 + SYSDIV2LSB) that reaches 80 MHz
+    SYSCTL_RCC_R = SYSCTL_RCC_XTAL_16MHZ | SYSCTL_RCC_OSCSRC_MAIN | SYSCTL_RCC_USESYSDIV | SYSCTL_RCC_BYPASS;
+    SYSCTL_RCC2_R = SYSCTL_RCC2_USERCC2 | SYSCTL_RCC2_DIV400 | SYSCTL_RCC2_OSCSRC2_MO | SYSCTL_RCC2_BYPASS2
+                  | SYSCTL_RCC2_USBPWRDN | ((CLOCK_PLL_DIVISOR - 1) << (SYSCTL_RCC2_SYSDIV2_S - 1));
+    // Stay on the crystal until the PLL reports lock, then switch over without a fixed delay
+    while (!(SYSCTL_PLLSTAT_R & SYSCTL_PLLSTAT_LOCK));
+    SYSCTL_RCC2_R &= ~SYSCTL_RCC2_BYPASS2;
+#else
+    // Run directly from the 16 MHz XTAL with the PLL powered down
+    SYSCTL_RCC_R = SYSCTL_RCC_XTAL_16MHZ | SYSCTL_RCC_OSCSRC_MAIN | SYSCTL_RCC_BYPASS | SYSCTL_RCC_PWRDN;
+#endif
 }
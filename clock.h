@@ -7,7 +7,7 @@
 
 // Target Platform: EK-TM4C123GXL
 // Target uC:       TM4C123GH6PM
-// System Clock:    -
+// System Clock:    16, 40, 50 or 80 MHz (SYSTEM_CLOCK_MHZ)
 
 // Hardware configuration:
 // 16 MHz external crystal oscillator
@@ -19,10 +19,31 @@
 #ifndef CLOCK_H_
 #define CLOCK_H_
 
+// Select the profile with -DSYSTEM_CLOCK_MHZ=16, 40, 50 or 80. 16 MHz runs
+// straight from the crystal with the PLL powered down, the others divide the
+// 400 MHz PLL output. Timing constants below are derived from this one value.
+#ifndef SYSTEM_CLOCK_MHZ
+#define SYSTEM_CLOCK_MHZ    40
+#endif
+
+#if SYSTEM_CLOCK_MHZ == 16
+#define CLOCK_USE_PLL       0
+#elif SYSTEM_CLOCK_MHZ == 40 || SYSTEM_CLOCK_MHZ == 50 || SYSTEM_CLOCK_MHZ == 80
+#define CLOCK_USE_PLL       1
+#define CLOCK_PLL_DIVISOR   (400 / SYSTEM_CLOCK_MHZ)    // 10, 8 or 5
+#else
+#error "SYSTEM_CLOCK_MHZ must be 16, 40, 50 or 80"
+#endif
+
+#define SYSTEM_CLOCK_HZ     (SYSTEM_CLOCK_MHZ * 1000000UL)
+#define CYCLES_PER_US       (SYSTEM_CLOCK_MHZ)
+#define CYCLES_PER_MS       (SYSTEM_CLOCK_MHZ * 1000UL)
+#define TIMER32_MAX_MS      (0xFFFFFFFFUL / CYCLES_PER_MS)   // longest 32-bit timer load, 53687 ms at 80 MHz
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
-void initSystemClockTo40Mhz(void);
+void initSystemClock(void);
 
 #endif
@@ -0,0 +1,83 @@
+// COBS Framing
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+// Consistent Overhead Byte Stuffing removes every 0x00 from a record so a
+// single 0x00 can delimit frames and a receiver can resynchronize anywhere.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "cobs.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Encodes length bytes into out (COBS_MAX(length) bytes), returns encoded length
+uint16_t cobsEncode(const uint8_t* in, uint16_t length, uint8_t* out)
+{
+    uint16_t read = 0;
+    uint16_t write = 1;
+    uint16_t codeIndex = 0;
+    uint8_t code = 1;
+
+    while (read < length)
+    {
+        if (in[read] == 0)
+        {
+            out[codeIndex] = code;
+            codeIndex = write++;
+            code = 1;
+        }
+        else
+        {
+            out[write++] = in[read];
+            code++;
+            if (code == 0xFF)
+            {
+                out[codeIndex] = code;
+                codeIndex = write++;
+                code = 1;
+            }
+        }
+        read++;
+    }
+    out[codeIndex] = code;
+    return write;
+}
+
+// Decodes one frame (without delimiter), returns decoded length or 0 if malformed
+uint16_t cobsDecode(const uint8_t* in, uint16_t length, uint8_t* out)
+{
+    uint16_t read = 0;
+    uint16_t write = 0;
+
+    while (read < length)
+    {
+        uint8_t code = in[read++];
+        uint8_t i;
+
+        if (code == 0 || read + code - 1 > length)
+        {
+            return 0;
+        }
+        for (i = 1; i < code; i++)
+        {
+            out[write++] = in[read++];
+        }
+        if (code != 0xFF && read < length)
+        {
+            out[write++] = 0;
+        }
+    }
+    return write;
+}
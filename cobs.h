@@ -0,0 +1,26 @@
+// COBS Framing
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+
+// Worst case encoded size of n bytes, not counting the 0x00 delimiter
+#define COBS_MAX(n) ((n) + (n)/254 + 1)
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint16_t cobsEncode(const uint8_t* in, uint16_t length, uint8_t* out);
+uint16_t cobsDecode(const uint8_t* in, uint16_t length, uint8_t* out);
+
+#endif
@@ -0,0 +1,88 @@
+// Command Dispatcher
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+// Looks up the first field of a parsed line in a sorted command table and
+// checks the argument count and types before calling the handler, so the
+// handlers only deal with values. The first field is compared in place;
+// parseFields has already terminated it in the line buffer.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+#include "command.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Binary search of a table sorted by name, returns 0 if not found
+const COMMAND* findCommand(const COMMAND table[], uint8_t count, const char* name)
+{
+    uint8_t low = 0;
+    uint8_t high = count;
+
+    while (low < high)
+    {
+        uint8_t mid = (low + high) / 2;
+        int cmp = strcmp(name, table[mid].name);
+
+        if (cmp == 0)
+        {
+            return &table[mid];
+        }
+        else if (cmp < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    return 0;
+}
+
+uint8_t dispatchCommand(const COMMAND table[], uint8_t count, USER_DATA* data)
+{
+    const COMMAND* command;
+    uint8_t args, i;
+
+    if (data->fieldCount == 0 || data->fieldType[0] != 'a')
+    {
+        return (data->fieldCount == 0) ? CMD_EMPTY : CMD_UNKNOWN;
+    }
+
+    command = findCommand(table, count, &data->buffer[data->fieldPosition[0]]);
+    if (command == 0)
+    {
+        return CMD_UNKNOWN;
+    }
+
+    args = data->fieldCount - 1;
+    if (args < command->minArgs || args > strlen(command->argTypes))
+    {
+        return CMD_ARG_COUNT;
+    }
+
+    for (i = 0; i < args; i++)
+    {
+        char type = command->argTypes[i];
+        if (type != '*' && type != data->fieldType[i+1])
+        {
+            return CMD_ARG_TYPE;
+        }
+    }
+
+    command->handler(data);
+    return CMD_OK;
+}
@@ -0,0 +1,42 @@
+// Command Dispatcher
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stdint.h>
+#include "parse.h"
+
+typedef void (*COMMAND_HANDLER)(USER_DATA* data);
+
+// One CLI command; tables must be sorted by name for the binary search
+typedef struct _COMMAND
+{
+    const char* name;
+    uint8_t minArgs;                // required arguments
+    const char* argTypes;           // type of each argument, 'n' numeric, 'a' alpha, '*' either
+    COMMAND_HANDLER handler;
+    const char* help;
+} COMMAND;
+
+#define CMD_OK          0
+#define CMD_EMPTY       1           // blank line
+#define CMD_UNKNOWN     2
+#define CMD_ARG_COUNT   3
+#define CMD_ARG_TYPE    4
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+const COMMAND* findCommand(const COMMAND table[], uint8_t count, const char* name);
+uint8_t dispatchCommand(const COMMAND table[], uint8_t count, USER_DATA* data);
+
+#endif
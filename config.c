@@ -0,0 +1,605 @@
+// Event Configuration
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// RAM image of the event/pattern words in EEPROM (see eeprom.c). Reads come
+// from RAM. Outside a transaction the image is a write-back cache: a write
+// that changes a word only marks it dirty, repeated writes to a dirty word
+// coalesce, and serviceConfig() writes one dirty word per call from the
+// main loop without waiting for the EEPROM. Words are addressed through the
+// wear leveling block map (wear.c).
+// Between beginConfig() and commitConfig() writes are staged in a second
+// image; commit validates the staged image as a whole and then writes only
+// the words that changed.
+//
+// A commit of more than one word goes through a redo journal in EEPROM
+// blocks 16-27 so a reset part way through cannot leave a half-applied
+// profile: the changed values and a bitmap of their addresses are written
+// first, then the header word (the commit point), then the words in place,
+// then the header is cleared. initConfig() replays a journal whose header
+// is still set.
+//
+// The table is followed by a schema header (magic, version, CRC16 of the
+// table). initConfig() checks it once at boot:
+//  - no header (erased magic): the pre-schema layout is migrated by writing
+//    an explicit EVENT_INACTIVE and zeroed fields for unused events, and any
+//    event that still fails validation is deactivated
+//  - CRC mismatch with the flush mark set and every event valid: an
+//    interrupted background flush, kept and the CRC rewritten
+//  - anything else wrong, including a CRC mismatch without the mark: the
+//    default profile is written
+// A background flush writes CONFIG_FLUSH_MARK before its first data word,
+// then the data words, then the CRC, then clears the mark, so corruption
+// that happens to leave every event valid is not mistaken for a flush. A
+// transaction commits the CRC and the cleared mark with its other words.
+//
+// exportConfig()/importConfig() move the whole image as one CRC protected
+// blob for provisioning (see tools/provision.c). An import is validated and
+// committed like any other transaction.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "eeprom.h"
+#include "pattern.h"
+#include "crc.h"
+#include "wear.h"
+
+#define JOURNAL_ADD         256                     // block 16
+#define JOURNAL_BITMAP_ADD  (JOURNAL_ADD + 1)
+#define JOURNAL_BITMAP_WORDS ((CONFIG_IMAGE_WORDS + 31) / 32)
+#define JOURNAL_DATA_ADD    (JOURNAL_BITMAP_ADD + JOURNAL_BITMAP_WORDS)
+#define JOURNAL_MAGIC       0x4A4E0000              // "JN" in the upper half, count in the lower
+#define JOURNAL_MAGIC_MASK  0xFFFF0000
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t liveImage[CONFIG_IMAGE_WORDS];
+static uint32_t stagedImage[CONFIG_IMAGE_WORDS];
+static bool staging = false;
+
+static uint32_t dirty[JOURNAL_BITMAP_WORDS];
+static uint16_t dirtyCount = 0;
+static uint16_t flushCursor = 0;
+static bool     crcStale = false;             // table changed since the CRC was last written
+
+uint8_t  configStatus = CONFIG_LOADED;
+uint32_t configWrites = 0;
+uint32_t configWritesSaved = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static bool isDirty(uint16_t add)
+{
+    return (dirty[add/32] & (1u << (add % 32))) != 0;
+}
+
+// Writes a configuration word in place, through the block map
+static void storeWord(uint16_t add, uint32_t data)
+{
+    writeEeprom(getWearAddress(add), data);
+    configWrites++;
+    noteWearWrite(add);
+}
+
+// Starts the write of a word in place without waiting, through the block map
+static void startStoreWord(uint16_t add, uint32_t data)
+{
+    liveImage[add] = data;
+    startWriteEeprom(getWearAddress(add), data);
+    configWrites++;
+    noteWearWrite(add);
+}
+
+static uint16_t getTableCrc(const uint32_t image[])
+{
+    uint16_t crc = CRC16_INIT;
+    uint8_t bytes[4];
+    uint16_t add;
+
+    for (add = 0; add < CONFIG_WORDS; add++)
+    {
+        bytes[0] = image[add];
+        bytes[1] = image[add] >> 8;
+        bytes[2] = image[add] >> 16;
+        bytes[3] = image[add] >> 24;
+        crc = crc16(crc, bytes, 4);
+    }
+    return crc;
+}
+
+static void setHeader(uint32_t image[])
+{
+    image[CONFIG_MAGIC_ADD] = CONFIG_MAGIC;
+    image[CONFIG_VERSION_ADD] = CONFIG_VERSION;
+    image[CONFIG_CRC_ADD] = getTableCrc(image);
+    image[CONFIG_CRC_ADD + 1] = 0;
+}
+
+// Applies a committed journal to the event area and clears it
+static void replayJournal(uint32_t header)
+{
+    uint32_t bitmap[JOURNAL_BITMAP_WORDS];
+    uint16_t count = header & ~JOURNAL_MAGIC_MASK;
+    uint16_t add;
+    uint16_t n = 0;
+
+    readEepromBlock(JOURNAL_BITMAP_ADD, bitmap, JOURNAL_BITMAP_WORDS);
+    for (add = 0; add < CONFIG_IMAGE_WORDS && n < count; add++)
+    {
+        if (bitmap[add/32] & (1u << (add % 32)))
+        {
+            storeWord(add, readEeprom(JOURNAL_DATA_ADD + n));
+            n++;
+        }
+    }
+    writeEeprom(JOURNAL_ADD, 0);
+}
+
+// Safe fallback: each sensor alone warns of anything from 20 mm to 1 m
+static void setDefaultProfile(uint32_t image[])
+{
+    uint16_t add;
+    uint8_t e;
+
+    for (add = 0; add < CONFIG_WORDS; add++)
+    {
+        image[add] = 0;
+    }
+    for (e = 0; e < 20; e++)
+    {
+        image[8*e] = EVENT_INACTIVE;
+    }
+    for (e = 0; e < 3; e++)
+    {
+        image[8*e + 0] = e;
+        image[8*e + 1] = 20;
+        image[8*e + 2] = 1000;
+        image[8*e + 3] = 1;
+        image[PATTERN_ID_ADD + e] = 1;              // "tap"
+    }
+}
+
+// Rewrites a pre-schema image so every word has a defined meaning
+static void migrateLegacy(uint32_t image[])
+{
+    int8_t bad;
+    uint8_t e, w;
+
+    for (e = 0; e < 20; e++)
+    {
+        uint32_t* event = &image[8*e];
+        bool active = (e < 16) ? (event[0] <= 2) : (event[0] == 1);
+
+        if (!active)
+        {
+            event[0] = EVENT_INACTIVE;
+        }
+        if (event[3] != 1)
+        {
+            event[3] = 0;
+        }
+        for (w = 4; w < 8; w++)
+        {
+            if (event[w] == 0xFFFFFFFF)
+            {
+                event[w] = 0;
+            }
+        }
+        if (image[PATTERN_ID_ADD + e] >= getPatternCount())
+        {
+            image[PATTERN_ID_ADD + e] = PATTERN_LEGACY;
+        }
+    }
+
+    while ((bad = validateConfig(image)) >= 0)
+    {
+        image[8*bad] = EVENT_INACTIVE;
+    }
+}
+
+// Validates the loaded image against its header, see the top of the file
+static void checkSchema(void)
+{
+    int8_t bad;
+
+    bool header = liveImage[CONFIG_MAGIC_ADD] == CONFIG_MAGIC && liveImage[CONFIG_VERSION_ADD] == CONFIG_VERSION;
+    bool flushing = liveImage[CONFIG_FLUSH_ADD] == CONFIG_FLUSH_MARK;
+
+    if (header && liveImage[CONFIG_CRC_ADD] == getTableCrc(liveImage) && validateConfig(liveImage) < 0)
+    {
+        configStatus = CONFIG_LOADED;
+        if (liveImage[CONFIG_FLUSH_ADD] != 0)
+        {
+            storeWord(CONFIG_FLUSH_ADD, 0);             //reset after the CRC but before the mark was cleared
+            liveImage[CONFIG_FLUSH_ADD] = 0;
+        }
+        return;
+    }
+    else if (header && flushing && validateConfig(liveImage) < 0)
+    {
+        configStatus = CONFIG_RECOVERED;
+        beginConfig();
+    }
+    else if (liveImage[CONFIG_MAGIC_ADD] == 0xFFFFFFFF)
+    {
+        configStatus = CONFIG_MIGRATED;
+        beginConfig();
+        migrateLegacy(stagedImage);
+    }
+    else
+    {
+        configStatus = CONFIG_DEFAULTED;
+        beginConfig();
+        setDefaultProfile(stagedImage);
+    }
+    commitConfig(&bad);
+}
+
+void initConfig(void)
+{
+    uint32_t header;
+    uint16_t add;
+
+    initWear();
+    header = readEeprom(JOURNAL_ADD);
+    if ((header & JOURNAL_MAGIC_MASK) == JOURNAL_MAGIC)
+    {
+        replayJournal(header);
+    }
+
+    //one burst per block, blocks may be remapped by wear leveling
+    for (add = 0; add < CONFIG_IMAGE_WORDS; add += 16)
+    {
+        uint16_t count = (CONFIG_IMAGE_WORDS - add < 16) ? CONFIG_IMAGE_WORDS - add : 16;
+        readEepromBlock(getWearAddress(add), &liveImage[add], count);
+    }
+    for (add = 0; add < JOURNAL_BITMAP_WORDS; add++)
+    {
+        dirty[add] = 0;
+    }
+    dirtyCount = 0;
+    crcStale = false;
+    staging = false;
+
+    checkSchema();
+}
+
+uint32_t readConfig(uint16_t add)
+{
+    return liveImage[add];
+}
+
+// Updates a word of the live image and marks it for serviceConfig()
+static void writeConfigWord(uint16_t add, uint32_t data)
+{
+    if (liveImage[add] == data)
+    {
+        return;
+    }
+    liveImage[add] = data;
+    if (isDirty(add))
+    {
+        configWritesSaved++;
+    }
+    else
+    {
+        dirty[add/32] |= 1u << (add % 32);
+        dirtyCount++;
+    }
+}
+
+// Stages the word during a transaction, otherwise caches it for serviceConfig()
+void writeConfig(uint16_t add, uint32_t data)
+{
+    if (add >= CONFIG_WORDS)
+    {
+        return;
+    }
+
+    if (staging)
+    {
+        stagedImage[add] = data;
+    }
+    else if (liveImage[add] == data)
+    {
+        configWritesSaved++;
+    }
+    else
+    {
+        writeConfigWord(add, data);
+        crcStale = true;
+    }
+}
+
+// Dirty words plus the CRC and flush mark words still to write
+uint16_t getConfigPending(void)
+{
+    return dirtyCount + (crcStale ? 1 : 0) + (liveImage[CONFIG_FLUSH_ADD] != 0 ? 1 : 0);
+}
+
+// Starts the write of the next word of the flush if the EEPROM is idle:
+// the mark, the dirty words, the CRC, then the cleared mark
+void serviceConfig(void)
+{
+    uint16_t add;
+
+    if (isEepromBusy())
+    {
+        return;
+    }
+
+    if (dirtyCount != 0 && liveImage[CONFIG_FLUSH_ADD] != CONFIG_FLUSH_MARK)
+    {
+        startStoreWord(CONFIG_FLUSH_ADD, CONFIG_FLUSH_MARK);
+        return;
+    }
+
+    if (dirtyCount == 0)
+    {
+        //the CRC goes out once the data words it covers have been written
+        if (crcStale)
+        {
+            crcStale = false;
+            startStoreWord(CONFIG_CRC_ADD, getTableCrc(liveImage));
+        }
+        else if (liveImage[CONFIG_FLUSH_ADD] != 0)
+        {
+            startStoreWord(CONFIG_FLUSH_ADD, 0);
+        }
+        return;
+    }
+
+    for (add = flushCursor; !isDirty(add); )
+    {
+        add = (add + 1 < CONFIG_IMAGE_WORDS) ? add + 1 : 0;
+    }
+    flushCursor = add;
+
+    dirty[add/32] &= ~(1u << (add % 32));
+    dirtyCount--;
+    startStoreWord(add, liveImage[add]);
+}
+
+// Writes every dirty word, waiting for each
+void flushConfig(void)
+{
+    while (getConfigPending() != 0)
+    {
+        serviceConfig();
+    }
+    while (isEepromBusy());
+}
+
+bool isConfigStaging(void)
+{
+    return staging;
+}
+
+void beginConfig(void)
+{
+    uint16_t add;
+
+    for (add = 0; add < CONFIG_IMAGE_WORDS; add++)
+    {
+        stagedImage[add] = liveImage[add];
+    }
+    staging = true;
+}
+
+void abortConfig(void)
+{
+    staging = false;
+}
+
+uint8_t getStagedChanges(void)
+{
+    uint8_t count = 0;
+    uint16_t add;
+
+    if (!staging)
+    {
+        return 0;
+    }
+    for (add = 0; add < CONFIG_IMAGE_WORDS; add++)
+    {
+        if (stagedImage[add] != liveImage[add])
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Checks every active event of an image, returns the first bad event or -1
+int8_t validateConfig(const uint32_t image[])
+{
+    int8_t e;
+
+    for (e = 0; e < 20; e++)
+    {
+        const uint32_t* event = &image[8*e];
+        bool active;
+
+        if (e < 16)
+        {
+            active = (event[0] <= 2);
+            if (active && event[1] > event[2])
+            {
+                return e;                           // MIN above MAX
+            }
+        }
+        else
+        {
+            active = (event[0] == 1);
+            if (active && (event[1] >= 16 || event[2] >= 16))
+            {
+                return e;                           // compound of a non-simple event
+            }
+        }
+
+        if (active && event[3] == 1)
+        {
+            uint32_t id = image[PATTERN_ID_ADD + e];
+            if (id != 0xFFFFFFFF && id >= getPatternCount())
+            {
+                return e;
+            }
+            if (id == PATTERN_LEGACY || id == 0xFFFFFFFF)
+            {
+                if (event[7] > 100)
+                {
+                    return e;                       // PWM duty out of range
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+// Validates the staged image and writes the changed words atomically
+uint8_t commitConfig(int8_t* badEvent)
+{
+    uint32_t bitmap[JOURNAL_BITMAP_WORDS];
+    uint16_t count = 0;
+    uint16_t add;
+
+    if (!staging)
+    {
+        return CONFIG_NOT_STAGING;
+    }
+
+    *badEvent = validateConfig(stagedImage);
+    if (*badEvent >= 0)
+    {
+        return CONFIG_INVALID;
+    }
+    flushConfig();
+    setHeader(stagedImage);
+
+    for (add = 0; add < JOURNAL_BITMAP_WORDS; add++)
+    {
+        bitmap[add] = 0;
+    }
+    for (add = 0; add < CONFIG_IMAGE_WORDS; add++)
+    {
+        if (stagedImage[add] != liveImage[add])
+        {
+            bitmap[add/32] |= 1u << (add % 32);
+            count++;
+        }
+    }
+
+    // A single word write is atomic on its own
+    if (count > 1)
+    {
+        uint16_t n = 0;
+        for (add = 0; add < CONFIG_IMAGE_WORDS; add++)
+        {
+            if (bitmap[add/32] & (1u << (add % 32)))
+            {
+                writeEeprom(JOURNAL_DATA_ADD + n++, stagedImage[add]);
+                configWrites++;
+            }
+        }
+        writeEepromBlock(JOURNAL_BITMAP_ADD, bitmap, JOURNAL_BITMAP_WORDS);
+        writeEeprom(JOURNAL_ADD, JOURNAL_MAGIC | count);
+        configWrites += JOURNAL_BITMAP_WORDS + 1;
+    }
+
+    for (add = 0; add < CONFIG_IMAGE_WORDS; add++)
+    {
+        if (bitmap[add/32] & (1u << (add % 32)))
+        {
+            storeWord(add, stagedImage[add]);
+            liveImage[add] = stagedImage[add];
+        }
+    }
+
+    if (count > 1)
+    {
+        writeEeprom(JOURNAL_ADD, 0);
+        configWrites++;
+    }
+
+    staging = false;
+    loadEventPatterns();
+    return CONFIG_OK;
+}
+
+// Serializes the committed image into blob (CONFIG_BLOB_SIZE bytes), returns its length
+uint16_t exportConfig(uint8_t blob[])
+{
+    uint16_t length = CONFIG_BLOB_HEADER;
+    uint16_t add;
+    uint16_t crc;
+
+    blob[0] = 'H';
+    blob[1] = 'C';
+    blob[2] = CONFIG_BLOB_VERSION;
+    blob[3] = 0;
+    blob[4] = CONFIG_WORDS & 0xFF;
+    blob[5] = CONFIG_WORDS >> 8;
+    for (add = 0; add < CONFIG_WORDS; add++)
+    {
+        blob[length++] = liveImage[add];
+        blob[length++] = liveImage[add] >> 8;
+        blob[length++] = liveImage[add] >> 16;
+        blob[length++] = liveImage[add] >> 24;
+    }
+    crc = crc16(CRC16_INIT, blob, length);
+    blob[length++] = crc & 0xFF;
+    blob[length++] = crc >> 8;
+    return length;
+}
+
+// Checks a blob and replaces the image with it. Inside an open transaction
+// the blob is only staged; otherwise it is committed at once.
+uint8_t importConfig(const uint8_t blob[], uint16_t length, int8_t* badEvent)
+{
+    bool ownTransaction = !staging;
+    uint16_t add;
+    const uint8_t* p = &blob[CONFIG_BLOB_HEADER];
+
+    *badEvent = -1;
+    if (length != CONFIG_BLOB_SIZE || blob[0] != 'H' || blob[1] != 'C'
+        || blob[2] != CONFIG_BLOB_VERSION || (blob[4] | (blob[5] << 8)) != CONFIG_WORDS
+        || crc16(CRC16_INIT, blob, length - 2) != (blob[length-2] | (blob[length-1] << 8)))
+    {
+        return CONFIG_BAD_BLOB;
+    }
+
+    if (ownTransaction)
+    {
+        beginConfig();
+    }
+    for (add = 0; add < CONFIG_WORDS; add++, p += 4)
+    {
+        stagedImage[add] = p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    if (!ownTransaction)
+    {
+        return CONFIG_OK;
+    }
+    if (commitConfig(badEvent) != CONFIG_OK)
+    {
+        abortConfig();
+        return CONFIG_INVALID;
+    }
+    return CONFIG_OK;
+}
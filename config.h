@@ -0,0 +1,72 @@
+// Event Configuration
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONFIG_WORDS        180     // 20 events x 8 words + 20 pattern IDs
+#define CONFIG_IMAGE_WORDS  184     // table plus the schema header
+
+// Schema header, after the table in block 11
+#define CONFIG_MAGIC_ADD    180
+#define CONFIG_VERSION_ADD  181
+#define CONFIG_CRC_ADD      182     // CRC16 of words 0-179 (little endian bytes)
+#define CONFIG_FLUSH_ADD    183     // CONFIG_FLUSH_MARK while a background flush is under way
+#define CONFIG_MAGIC        0x47464348  // "HCFG"
+#define CONFIG_VERSION      1
+#define CONFIG_FLUSH_MARK   0x464C5348  // "FLSH"
+
+// Schema 1 stores this in word 0 of an unused event instead of relying on
+// "anything but sensor 0-2" meaning inactive
+#define EVENT_INACTIVE      0xFFFFFFFF
+
+// How initConfig() found the configuration
+#define CONFIG_LOADED       0
+#define CONFIG_MIGRATED     1       // legacy layout without a header, normalized to schema 1
+#define CONFIG_RECOVERED    2       // interrupted flush with every event valid, CRC rewritten
+#define CONFIG_DEFAULTED    3       // corrupt, default profile written
+
+#define CONFIG_OK           0
+#define CONFIG_NOT_STAGING  1
+#define CONFIG_INVALID      2
+#define CONFIG_BAD_BLOB     3
+
+// Export/import blob: 'H' 'C', version, 0, u16 word count, words, CRC16 (all little endian)
+#define CONFIG_BLOB_VERSION 1
+#define CONFIG_BLOB_HEADER  6
+#define CONFIG_BLOB_SIZE    (CONFIG_BLOB_HEADER + 4*CONFIG_WORDS + 2)
+
+extern uint8_t configStatus;
+extern uint32_t configWrites;               // EEPROM word writes
+extern uint32_t configWritesSaved;          // unchanged or coalesced writes not made
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initConfig(void);
+uint32_t readConfig(uint16_t add);
+void writeConfig(uint16_t add, uint32_t data);
+uint16_t getConfigPending(void);
+void serviceConfig(void);
+void flushConfig(void);
+void beginConfig(void);
+uint8_t commitConfig(int8_t* badEvent);
+void abortConfig(void);
+bool isConfigStaging(void);
+uint8_t getStagedChanges(void);
+int8_t validateConfig(const uint32_t image[]);
+uint16_t exportConfig(uint8_t blob[]);
+uint8_t importConfig(const uint8_t blob[], uint16_t length, int8_t* badEvent);
+
+#endif
@@ -0,0 +1,41 @@
+// CRC Library
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), computed a nibble at a
+// time from a 16 entry table to keep flash use small.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "crc.h"
+
+static const uint16_t crcNibble[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Continues a CRC over length bytes; start with CRC16_INIT
+uint16_t crc16(uint16_t crc, const uint8_t* data, uint16_t length)
+{
+    while (length--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        crc = (crc << 4) ^ crcNibble[crc >> 12];
+        crc = (crc << 4) ^ crcNibble[crc >> 12];
+    }
+    return crc;
+}
@@ -0,0 +1,24 @@
+// CRC Library
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <stdint.h>
+
+#define CRC16_INIT 0xFFFF
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint16_t crc16(uint16_t crc, const uint8_t* data, uint16_t length);
+
+#endif
@@ -0,0 +1,117 @@
+// Live Display
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// The "display" command subscribes to periodic text output instead of
+// looping in the handler, so events and haptics keep running while a unit
+// is watched. serviceDisplay() runs as a periodic scheduler task whose period
+// setDisplay() sets, or disables while the display is off so the CPU is not
+// woken for it. Each release builds one block for the selected sensors
+// and/or events and queues it only if it fits in the TX buffers, so a slow
+// terminal costs skipped updates rather than loop time.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "display.h"
+#include "sched.h"
+#include "uart0.h"
+#include "fmt.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+uint32_t displaySkipped = 0;
+
+static uint8_t  displayWhat = 0;
+static uint32_t displayMask;
+static uint8_t  displayTask = TASK_INVALID;
+static char     displayText[180];        // 3 sensor lines + 20 events
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Called once with the id addTask() returned for serviceDisplay()
+void setDisplayTask(uint8_t id)
+{
+    displayTask = id;
+}
+
+// what is a combination of DISPLAY_SENSORS and DISPLAY_EVENTS (0 = off),
+// bit N of mask selects sensor N and event N
+void setDisplay(uint8_t what, uint32_t periodMs, uint32_t mask)
+{
+    if (periodMs < DISPLAY_MIN_MS)
+    {
+        periodMs = DISPLAY_MIN_MS;
+    }
+    else if (periodMs > DISPLAY_MAX_MS)
+    {
+        periodMs = DISPLAY_MAX_MS;
+    }
+
+    displayMask = mask;
+    displaySkipped = 0;
+    displayWhat = what;
+    setTaskPeriod(displayTask, (what != 0) ? periodMs : 0);
+}
+
+bool isDisplayOn(void)
+{
+    return displayWhat != 0;
+}
+
+void serviceDisplay(const uint32_t distance[3], const uint8_t status[], uint8_t count)
+{
+    char* p = displayText;
+    uint8_t i;
+
+    if (displayWhat == 0)
+    {
+        return;
+    }
+
+    if (displayWhat & DISPLAY_SENSORS)
+    {
+        for (i = 0; i < 3; i++)
+        {
+            if (displayMask & (1 << i))
+            {
+                p = fmtU32(fmtStr(p, "Sensor "), i, 0);
+                p = fmtStr(fmtU32(fmtStr(p, ":    "), distance[i], 5), " (mm)\n");
+            }
+        }
+    }
+
+    if (displayWhat & DISPLAY_EVENTS)
+    {
+        p = fmtStr(p, "Events active:");
+        for (i = 0; i < count; i++)
+        {
+            if ((displayMask & (1 << i)) && status[i] == 1)
+            {
+                p = fmtU32(p, i, 3);
+            }
+        }
+        p = fmtStr(p, "\n");
+    }
+    p = fmtStr(p, "\n");
+
+    if (getUart0TxFree() < p - displayText)
+    {
+        displaySkipped++;
+        return;
+    }
+    tryPutsUart0(displayText);
+}
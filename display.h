@@ -0,0 +1,35 @@
+// Live Display
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DISPLAY_SENSORS     1
+#define DISPLAY_EVENTS      2
+
+#define DISPLAY_DEFAULT_MS  100
+#define DISPLAY_MIN_MS      10
+#define DISPLAY_MAX_MS      60000
+
+extern uint32_t displaySkipped;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void setDisplayTask(uint8_t id);
+void setDisplay(uint8_t what, uint32_t periodMs, uint32_t mask);
+bool isDisplayOn(void);
+void serviceDisplay(const uint32_t distance[3], const uint8_t status[], uint8_t count);
+
+#endif
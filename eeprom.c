@@ -13,6 +13,7 @@
 //-----------------------------------------------------------------------------
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "tm4c123gh6pm.h"
 #include "eeprom.h"
 
@@ -23,25 +24,75 @@
 void initEeprom(void)
 {
     SYSCTL_RCGCEEPROM_R = 1;
-    _delay_cycles(3);
+    while (!(SYSCTL_PREEPROM_R & SYSCTL_PREEPROM_R0));
     while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
 }
 
 void writeEeprom(uint16_t add, uint32_t data)
 {
+    startWriteEeprom(add, data);
+    while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+}
+
+// Starts a write without waiting for it; poll isEepromBusy() before the next access
+void startWriteEeprom(uint16_t add, uint32_t data)
+{
+    while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
     EEPROM_EEBLOCK_R = add >> 4;
     EEPROM_EEOFFSET_R = add & 0xF;
     EEPROM_EERDWR_R = data;
-    while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+}
+
+bool isEepromBusy(void)
+{
+    return (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING) != 0;
 }
 
 uint32_t readEeprom(uint16_t add)
 {
+    while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
     EEPROM_EEBLOCK_R = add >> 4;
     EEPROM_EEOFFSET_R = add & 0xF;
     return EEPROM_EERDWR_R;
 }
 
+// Reads count consecutive words with one address setup per block (EERDWRINC
+// wraps within a block, so the block is advanced by hand)
+void readEepromBlock(uint16_t add, uint32_t data[], uint16_t count)
+{
+    uint16_t i;
+
+    while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+    EEPROM_EEBLOCK_R = add >> 4;
+    EEPROM_EEOFFSET_R = add & 0xF;
+    for (i = 0; i < count; i++)
+    {
+        if (i != 0 && ((add + i) & 0xF) == 0)
+        {
+            EEPROM_EEBLOCK_R = (add + i) >> 4;
+        }
+        data[i] = EEPROM_EERDWRINC_R;
+    }
+}
+
+void writeEepromBlock(uint16_t add, const uint32_t data[], uint16_t count)
+{
+    uint16_t i;
+
+    while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+    EEPROM_EEBLOCK_R = add >> 4;
+    EEPROM_EEOFFSET_R = add & 0xF;
+    for (i = 0; i < count; i++)
+    {
+        if (i != 0 && ((add + i) & 0xF) == 0)
+        {
+            EEPROM_EEBLOCK_R = (add + i) >> 4;
+        }
+        EEPROM_EERDWRINC_R = data[i];
+        while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING);
+    }
+}
+
 
 //////////// EEPROM STRUCTURE //////////////
 //           0+8N    Sensor N             // ~\
@@ -52,4 +103,10 @@ uint32_t readEeprom(uint16_t add)
 //           5+8N    time on              //   \- pattern
 //           6+8N    time off             //   /
 //           7+8N      pwm                // ~/
+//                                        //
+//         160+N   pattern ID             // - library pattern (0 = legacy)
+//         180-182 magic, version, CRC    // - schema header, see config.c
+//                                        //
+//         192-204 block map, wear counts // - see wear.c
+//         256-446 commit journal         // - see config.c
 ////////////////////////////////////////////
@@ -11,12 +11,19 @@
 #ifndef EEPROM_H_
 #define EEPROM_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
 void initEeprom(void);
 void writeEeprom(uint16_t add, uint32_t data);
+void startWriteEeprom(uint16_t add, uint32_t data);
+bool isEepromBusy(void);
 uint32_t readEeprom(uint16_t add);
+void readEepromBlock(uint16_t add, uint32_t data[], uint16_t count);
+void writeEepromBlock(uint16_t add, const uint32_t data[], uint16_t count);
 
 #endif
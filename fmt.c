@@ -0,0 +1,95 @@
+// Integer and String Formatting
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+// Replaces snprintf on the CLI output paths. Each call appends one item at
+// out, terminates the string and returns a pointer to the terminator, so a
+// line is built by chaining calls:
+//     p = fmtStr(str, "EVENT ");
+//     p = fmtU32(p, event, 2);
+// Widths pad with spaces like "%2u" (numbers, right aligned) and "%-10s"
+// (strings, left aligned). The caller sizes the buffer; nothing is checked.
+// tools/fmt_bench.c compares it with snprintf.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "fmt.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+char* fmtStr(char* out, const char* str)
+{
+    while (*str != '\0')
+    {
+        *out++ = *str++;
+    }
+    *out = '\0';
+    return out;
+}
+
+char* fmtStrPad(char* out, const char* str, uint8_t width)
+{
+    char* start = out;
+
+    out = fmtStr(out, str);
+    while (out - start < width)
+    {
+        *out++ = ' ';
+    }
+    *out = '\0';
+    return out;
+}
+
+// Writes digits and sign right aligned in width
+static char* fmtDigits(char* out, uint32_t value, char sign, uint8_t width)
+{
+    char digits[11];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    if (sign != 0)
+    {
+        digits[count++] = sign;
+    }
+    while (width > count)
+    {
+        *out++ = ' ';
+        width--;
+    }
+    while (count != 0)
+    {
+        *out++ = digits[--count];
+    }
+    *out = '\0';
+    return out;
+}
+
+char* fmtU32(char* out, uint32_t value, uint8_t width)
+{
+    return fmtDigits(out, value, 0, width);
+}
+
+char* fmtI32(char* out, int32_t value, uint8_t width)
+{
+    if (value < 0)
+    {
+        return fmtDigits(out, -(uint32_t)value, '-', width);
+    }
+    return fmtDigits(out, value, 0, width);
+}
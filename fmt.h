@@ -0,0 +1,25 @@
+// Integer and String Formatting
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+#ifndef FMT_H_
+#define FMT_H_
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+char* fmtStr(char* out, const char* str);
+char* fmtStrPad(char* out, const char* str, uint8_t width);
+char* fmtU32(char* out, uint32_t value, uint8_t width);
+char* fmtI32(char* out, int32_t value, uint8_t width);
+
+#endif
@@ -0,0 +1,167 @@
+// Haptic Pattern Sequencer
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Timer 1A is used as a one-shot step timer
+
+// Plays a pattern in the background: each timeout of Timer 1A applies the
+// next step's PWM delta and reloads the timer with the step duration, so the
+// main loop keeps evaluating events while the motor runs. A step longer
+// than one timer load (TIMER32_MAX_MS) is timed as a chain of loads.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "haptic.h"
+#include "pattern.h"
+#include "latency.h"
+#include "clock.h"
+#include "perf.h"
+
+
+#define HAPTIC_IDLE     0
+#define HAPTIC_PLAYING  1
+#define HAPTIC_HOLDOFF  2
+
+void setMotorSpeed(uint32_t speed);
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static const PATTERN* activePattern;
+static volatile uint8_t hapticState = HAPTIC_IDLE;
+static uint8_t stepIndex;
+static uint8_t repeatLeft;
+static int16_t pwm;
+static uint32_t stepLeftMs;                 // rest of a step too long for one timer load
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initHaptic(void)
+{
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1;
+    while (!(SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R1));
+
+    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
+    TIMER1_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
+    TIMER1_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;          // configure for one-shot mode (count down)
+    TIMER1_IMR_R = TIMER_IMR_TATOIM;                 // turn-on interrupts
+    NVIC_EN0_R = 1 << (INT_TIMER1A-16);              // turn-on interrupt 37 (TIMER1A)
+}
+
+static void loadStepTimer(uint32_t ms)
+{
+    uint32_t load = (ms > TIMER32_MAX_MS) ? TIMER32_MAX_MS : ms;
+    uint32_t cycles = load * CYCLES_PER_MS;
+
+    stepLeftMs = ms - load;
+
+    if (cycles == 0)
+    {
+        cycles = 1;
+    }
+    TIMER1_TAILR_R = cycles;
+    TIMER1_CTL_R |= TIMER_CTL_TAEN;
+}
+
+// Applies the next step, or enters holdoff once all repeats are played
+static void playStep(void)
+{
+    const PATTERN_STEP* step;
+    int16_t previous;
+
+    if (stepIndex >= activePattern->stepCount)
+    {
+        stepIndex = 0;
+        repeatLeft--;
+    }
+
+    if (repeatLeft == 0)
+    {
+        setMotorSpeed(0);
+        hapticState = HAPTIC_HOLDOFF;
+        loadStepTimer(HAPTIC_HOLDOFF_MS);
+        return;
+    }
+
+    step = &activePattern->steps[stepIndex++];
+    previous = pwm;
+    pwm += step->pwmDelta;
+    if (pwm < 0)   pwm = 0;
+    if (pwm > 100) pwm = 100;
+
+    setMotorSpeed(pwm);
+    if (previous == 0 && pwm > 0)
+    {
+        markPwmEnable();
+    }
+    loadStepTimer((uint32_t)step->duration * activePattern->unitMs);
+}
+
+bool isHapticBusy(void)
+{
+    return hapticState != HAPTIC_IDLE;
+}
+
+void startPattern(const PATTERN* pattern)
+{
+    if (pattern == 0 || pattern->repeat == 0 || pattern->stepCount == 0)
+    {
+        return;
+    }
+
+    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+    activePattern = pattern;
+    stepIndex = 0;
+    repeatLeft = pattern->repeat;
+    pwm = 0;
+    hapticState = HAPTIC_PLAYING;
+    playStep();
+}
+
+void stopPattern(void)
+{
+    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+    setMotorSpeed(0);
+    stepLeftMs = 0;
+    hapticState = HAPTIC_IDLE;
+}
+
+//-----------------------------------------------------------------------------
+// Timer Interrupt
+//-----------------------------------------------------------------------------
+
+void haptic_isr()
+{
+    uint32_t perfStart = PERF_BEGIN();
+
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;               // clear interrupt flag
+
+    if (stepLeftMs != 0)
+    {
+        loadStepTimer(stepLeftMs);
+    }
+    else if (hapticState == HAPTIC_HOLDOFF)
+    {
+        hapticState = HAPTIC_IDLE;
+    }
+    else if (hapticState == HAPTIC_PLAYING)
+    {
+        playStep();
+    }
+    PERF_END(PERF_HAPTIC, perfStart);
+}
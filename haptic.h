@@ -0,0 +1,32 @@
+// Haptic Pattern Sequencer
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Timer 1A is used as a one-shot step timer
+
+#ifndef HAPTIC_H_
+#define HAPTIC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pattern.h"
+
+#define HAPTIC_HOLDOFF_MS 1000      // quiet time after a pattern before the next may start
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initHaptic(void);
+bool isHapticBusy(void);
+void startPattern(const PATTERN* pattern);
+void stopPattern(void);
+
+#endif
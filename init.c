@@ -6,7 +6,7 @@
 //-----------------------------------------------------------------------------
 
 // Target uC:       TM4C123GH6PM
-// System Clock:    40 MHz
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
 
 //-----------------------------------------------------------------------------
 // Device includes, defines, and assembler directives
@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include "tm4c123gh6pm.h"
+#include "clock.h"
 #include "init.h"
 
 // Bitband aliases
@@ -31,20 +32,63 @@
 #define ECHO_2_MASK 4      //2^2
 #define TRIGGER_MASK 16    //2^4
 
+// One sensor is triggered per period, so a full frame takes 3 periods
+#define TRIG_PERIOD_MS 75
+#define TRIG_PULSE_US  10
+
+// Interrupt priorities, 0 is highest and only the top 3 bits exist on this part.
+// Echo captures must never wait behind anything else, the haptic step timer
+// comes next so pattern timing stays exact, then the trigger and UART, and the
+// scheduler wake timer last since it only ends a sleep.
+#define PRIORITY_CAPTURE 0
+#define PRIORITY_HAPTIC  1
+#define PRIORITY_TRIGGER 2
+#define PRIORITY_UART    3
+#define PRIORITY_SCHED   4
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
+
+// Sets the priority of one interrupt, vector is the INT_ number from tm4c123gh6pm.h
+static void setInterruptPriority(uint8_t vector, uint8_t priority)
+{
+    volatile uint32_t* pri = &NVIC_PRI0_R + (vector-16)/4;
+    uint8_t shift = 8*((vector-16) % 4) + 5;
+
+    *pri = (*pri & ~(7 << shift)) | ((uint32_t)priority << shift);
+}
+
+static void initInterruptPriorities()
+{
+    setInterruptPriority(INT_WTIMER1A, PRIORITY_CAPTURE);
+    setInterruptPriority(INT_WTIMER2A, PRIORITY_CAPTURE);
+    setInterruptPriority(INT_WTIMER3A, PRIORITY_CAPTURE);
+    setInterruptPriority(INT_TIMER1A, PRIORITY_HAPTIC);
+    setInterruptPriority(INT_TIMER4A, PRIORITY_TRIGGER);
+    setInterruptPriority(INT_TIMER0A, PRIORITY_TRIGGER);
+    setInterruptPriority(INT_UART0, PRIORITY_UART);
+    setInterruptPriority(INT_TIMER2A, PRIORITY_SCHED);
+}
+
 // Initialize Hardware
 void initHw()
 {
-    // Initialize system clock to 40 MHz
-    initSystemClockTo40Mhz();
+    // Initialize system clock to SYSTEM_CLOCK_MHZ
+    initSystemClock();
+    initInterruptPriorities();
 
     // Enable clocks
-    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1 | SYSCTL_RCGCTIMER_R4;
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0 | SYSCTL_RCGCTIMER_R1 | SYSCTL_RCGCTIMER_R4;
     SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R1 | SYSCTL_RCGCWTIMER_R2 | SYSCTL_RCGCWTIMER_R3 | SYSCTL_RCGCWTIMER_R4;
     SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R0 | SYSCTL_RCGCGPIO_R4 | SYSCTL_RCGCGPIO_R2 | SYSCTL_RCGCGPIO_R3;
-    _delay_cycles(3);
+    // Wait for the peripherals to report ready instead of a fixed delay
+    while ((SYSCTL_PRTIMER_R & (SYSCTL_PRTIMER_R0 | SYSCTL_PRTIMER_R1 | SYSCTL_PRTIMER_R4))
+            != (SYSCTL_PRTIMER_R0 | SYSCTL_PRTIMER_R1 | SYSCTL_PRTIMER_R4));
+    while ((SYSCTL_PRWTIMER_R & (SYSCTL_PRWTIMER_R1 | SYSCTL_PRWTIMER_R2 | SYSCTL_PRWTIMER_R3 | SYSCTL_PRWTIMER_R4))
+            != (SYSCTL_PRWTIMER_R1 | SYSCTL_PRWTIMER_R2 | SYSCTL_PRWTIMER_R3 | SYSCTL_PRWTIMER_R4));
+    while ((SYSCTL_PRGPIO_R & (SYSCTL_PRGPIO_R0 | SYSCTL_PRGPIO_R4 | SYSCTL_PRGPIO_R2 | SYSCTL_PRGPIO_R3))
+            != (SYSCTL_PRGPIO_R0 | SYSCTL_PRGPIO_R4 | SYSCTL_PRGPIO_R2 | SYSCTL_PRGPIO_R3));
 
     // Configure ECHO and TRIGGER GPIOs
     GPIO_PORTE_DIR_R |= TRIG_1_MASK | TRIG_2_MASK | TRIG_0_MASK;    // TRIGs are outputs
@@ -133,11 +177,19 @@ void EnableTrigTimer()
     TIMER4_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
     TIMER4_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
     TIMER4_TAMR_R = TIMER_TAMR_TAMR_PERIOD;          // configure for periodic mode (count down)
-    TIMER4_TAILR_R = 3000000;                       // set load value to 4e6 for 20 Hz interrupt rate
+    TIMER4_TAILR_R = TRIG_PERIOD_MS * CYCLES_PER_MS; // set load value for one trigger every 75 ms
     TIMER4_IMR_R = TIMER_IMR_TATOIM;                 // turn-on interrupts
     TIMER4_CTL_R |= TIMER_CTL_TAEN;                  // turn-on timer
     NVIC_EN2_R = 1 << (INT_TIMER4A-16-64);             // turn-on interrupt 86 (TIMER4A)
 
+// Configure Timer 0 to end each trigger pulse without waiting in the ISR
+    TIMER0_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
+    TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
+    TIMER0_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;          // configure for one-shot mode (count down)
+    TIMER0_TAILR_R = TRIG_PULSE_US * CYCLES_PER_US;  // set load value for the trigger pulse width
+    TIMER0_IMR_R = TIMER_IMR_TATOIM;                 // turn-on interrupts
+    NVIC_EN0_R = 1 << (INT_TIMER0A-16);              // turn-on interrupt 35 (TIMER0A)
+
     WTIMER4_CTL_R &= ~TIMER_CTL_TAEN;                // turn-off counter before reconfiguring
     WTIMER4_CFG_R = 4;                               // configure as 32-bit counter (A only)
     WTIMER4_TAMR_R = TIMER_TAMR_TAMR_CAP | TIMER_TAMR_TACDIR; // configure for edge count mode, count up
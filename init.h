@@ -6,7 +6,7 @@
 //-----------------------------------------------------------------------------
 
 // Target uC:       TM4C123GH6PM
-// System Clock:    40 MHz
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
 
 #ifndef INIT_H_
 #define INIT_H_
@@ -8,13 +8,13 @@
 
 // Target Platform: EK-TM4C123GXL Evaluation Board
 // Target uC:       TM4C123GH6PM
-// System Clock:    40 MHz
+// System Clock:    40 MHz by default, see SYSTEM_CLOCK_MHZ in clock.h
 
 // Hardware configuration:
 // UART Interface:
 //   U0TX (PA1) and U0RX (PA0) are connected to the 2nd controller
 //   The USB on the 2nd controller enumerates to an ICDI interface and a virtual COM port
-//   Configured to 115,200 baud, 8N1
+//   Configured to 115,200 baud, 8N1 (baud command switches up to fcyc/8 at runtime, 5 Mbaud at 40 MHz)
 // Frequency counter and timer input:
 //   SIGNAL_IN on PC6 (WT1CCP0)
 
@@ -22,178 +22,193 @@
 // Device includes, defines, and assembler directives
 //-----------------------------------------------------------------------------
 
-#include <inttypes.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <stdio.h>
 //#include "motor.h"
 #include "init.h"
 #include "clock.h"
 #include "uart0.h"
-#include "wait.h"
 #include "eeprom.h"
+#include "config.h"
+#include "pattern.h"
+#include "haptic.h"
+#include "latency.h"
+#include "telemetry.h"
+#include "display.h"
+#include "blackbox.h"
+#include "power.h"
+#include "sched.h"
+#include "timebase.h"
+#include "perf.h"
+#include "mem.h"
+#include "cli.h"
+#include "fmt.h"
 #include "tm4c123gh6pm.h"
 
 #define TRIG_0   (*((volatile uint32_t *)(0x42000000 + (0x400243FC-0x40000000)*32 + 1*4))) //PE1
 #define TRIG_1   (*((volatile uint32_t *)(0x42000000 + (0x400243FC-0x40000000)*32 + 2*4))) //PE2
 #define TRIG_2   (*((volatile uint32_t *)(0x42000000 + (0x400243FC-0x40000000)*32 + 3*4))) //PE3
 
+// Silence on UART0 RX before a flash operation may stall its ISR
+#define FLASH_RX_QUIET_US 20000
+
+// Echo is timed round trip, so half the speed of sound (345 m/s) per clock tick
+#define ECHO_MM_PER_TICK (172500.0 / SYSTEM_CLOCK_HZ)
+
 // Global variables
 uint32_t distance[3];
-uint8_t  channel = 0;
+uint8_t  channel = 2;                            // first trigger wraps to sensor 0
 uint8_t  phase = 0;
 uint8_t  eventStatus[20];
+volatile uint32_t frameCount = 0;
+volatile uint32_t sampleCount = 0;               // bumped whenever a distance changes
+uint32_t echoStart;                              // timer value latched at the rising edge
+uint32_t bootFirstHaptic = 0;                    // us from clock ready, 0 until the first pattern
+
+// Task state
+uint32_t lastFrame = 0;
+uint32_t lastSample = 0;
+int8_t   activeEvent = -1;
+bool     firstFrame = true;
+bool     cliBusy = false;
+bool     stackWarned = false;
+USER_DATA data;
 
 //-----------------------------------------------------------------------------
 // Wide Timer Interrupts
 //-----------------------------------------------------------------------------
 
+// Both edges are timed from the value latched in TAR, so the time taken to
+// enter the ISR no longer adds to the distance. That delay is still recorded
+// per channel to check the interrupt priorities set in initHw().
+
 void isr_0()
 {
+    uint32_t perfStart = PERF_BEGIN();
+    uint32_t edge = WTIMER1_TAR_R;
+
+    noteCaptureLatency(0, WTIMER1_TAV_R - edge);
     if (phase == 0)
     {
-        WTIMER1_TAV_R = 0;
+        echoStart = edge;
         phase = 1;
     }
 
     else
     {
-        distance[0] = WTIMER1_TAV_R * 0.0043125;
+        distance[0] = (edge - echoStart) * ECHO_MM_PER_TICK;
         phase = 2;
+        sampleCount++;
+        markEchoCapture(0);
     }
 
     WTIMER1_ICR_R = TIMER_ICR_CAECINT;
+    PERF_END(PERF_CAPTURE, perfStart);
 }
 
 void isr_1()
 {
+    uint32_t perfStart = PERF_BEGIN();
+    uint32_t edge = WTIMER2_TAR_R;
+
+    noteCaptureLatency(1, WTIMER2_TAV_R - edge);
     if (phase == 0)
     {
-        WTIMER2_TAV_R = 0;
+        echoStart = edge;
         phase = 1;
     }
 
     else
     {
-        distance[1] = WTIMER2_TAV_R * 0.0043125;
+        distance[1] = (edge - echoStart) * ECHO_MM_PER_TICK;
         phase = 2;
+        sampleCount++;
+        markEchoCapture(1);
     }
 
     WTIMER2_ICR_R = TIMER_ICR_CAECINT;
+    PERF_END(PERF_CAPTURE, perfStart);
 }
 
 void isr_2()
 {
+    uint32_t perfStart = PERF_BEGIN();
+    uint32_t edge = WTIMER3_TAR_R;
+
+    noteCaptureLatency(2, WTIMER3_TAV_R - edge);
     if (phase == 0)
     {
-        WTIMER3_TAV_R = 0;
+        echoStart = edge;
         phase = 1;
     }
 
     else
     {
-        distance[2] = WTIMER3_TAV_R * 0.0043125;
+        distance[2] = (edge - echoStart) * ECHO_MM_PER_TICK;
         phase = 2;
+        sampleCount++;
+        markEchoCapture(2);
     }
 
     WTIMER3_ICR_R = TIMER_ICR_CAECINT;
+    PERF_END(PERF_CAPTURE, perfStart);
 }
 
 void timer_isr()
 {
+    uint32_t perfStart = PERF_BEGIN();
+
     if (phase != 2)
     {
         distance[channel] = 0;
+        sampleCount++;
     }
     channel++;
-    if (channel > 2) channel = 0;
+    if (channel > 2)
+    {
+        channel = 0;
+        frameCount++;
+    }
     phase = 0;
     switch (channel)
     {
     case 0 :
         TRIG_0 = 1;
-        waitMicrosecond(10);
-        TRIG_0 = 0;
         break;
 
     case 1 :
         TRIG_1 = 1;
-        waitMicrosecond(10);
-        TRIG_1 = 0;
         break;
 
     case 2 :
         TRIG_2 = 1;
-        waitMicrosecond(10);
-        TRIG_2 = 0;
         break;
     }
+    TIMER0_CTL_R |= TIMER_CTL_TAEN;              // trigPulseIsr ends the pulse
 
     TIMER4_ICR_R = TIMER_ICR_TATOCINT;           // clear interrupt flag
+    PERF_END(PERF_TRIGGER, perfStart);
 }
 
-//-----------------------------------------------------------------------------
-// Subroutines
-//-----------------------------------------------------------------------------
-
-char* getFieldString(USER_DATA * data, uint8_t fieldNumber)
+void trigPulseIsr()
 {
-    char fieldStringbuffer[MAX_CHARS+1] = NULL;
-    int index = data->fieldPosition[fieldNumber];
+    uint32_t perfStart = PERF_BEGIN();
 
-    //If fieldNumber is > field Count OR field is a number, return NULL
-    if ( (fieldNumber > (data->fieldCount)) || ((data->fieldType[fieldNumber]) == 'n') )
-    {
-        return NULL;
-    }
-
-    //Else, return the field equivalent String
-    else
-    {
-        //Loop through buffer string until NULL terminator is found
-        while( data->buffer[index] != NULL)
-        {
-            char c = data->buffer[index];
-            strncat(fieldStringbuffer, &c, 1);
-            index++;
-        }
-
-        char* fieldString = (fieldStringbuffer);
-        return fieldString;
-    }
+    TRIG_0 = 0;
+    TRIG_1 = 0;
+    TRIG_2 = 0;
+    TIMER0_ICR_R = TIMER_ICR_TATOCINT;           // clear interrupt flag
+    PERF_END(PERF_PULSE, perfStart);
 }
 
-int32_t getFieldInteger(USER_DATA *data, uint8_t fieldNumber)
-{
-    int32_t fieldInt = 0;
-    char fieldStringbuffer[MAX_CHARS+1] = NULL;
-
-    //ASSUMES FIELD NUMBER STARTS AT 0 NOT 1
-    //If fieldNumber is > fieldCount OR is an alpha value, return NULL
-    if ( (fieldNumber > (data->fieldCount)) || ((data->fieldType[(fieldNumber)]) == 'a') )
-    {
-        return fieldInt;
-    }
-
-    //Else, return the field equivalent Int using atoi()
-    else
-    {
-        int index = data->fieldPosition[fieldNumber];
-        while((data->buffer[index]) != NULL)
-        {
-            char c = data->buffer[index];
-            strncat(fieldStringbuffer, &c, 1);
-            index++;
-        }
-        fieldInt = atoi(fieldStringbuffer);
-        return fieldInt;
-    }
-}
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
 
 void checkEventTrue(uint8_t event_n)
 {
-    int32_t sensor_n = readEeprom(event_n*8);
+    int32_t sensor_n = readConfig(event_n*8);
 
     //Marks event false if sensor != 0, 1, or 2
     if ( (sensor_n != 0) && (sensor_n != 1) && (sensor_n != 2) )
@@ -204,8 +219,8 @@ void checkEventTrue(uint8_t event_n)
     //Marks events 0-15 true if distances are within range
     else
     {
-        uint32_t event_min = readEeprom(event_n*8 + 1);
-        uint32_t event_max = readEeprom(event_n*8 + 2);
+        uint32_t event_min = readConfig(event_n*8 + 1);
+        uint32_t event_max = readConfig(event_n*8 + 2);
         uint32_t dist = distance[sensor_n];
 
         if (dist >= event_min && dist <= event_max)
@@ -222,9 +237,9 @@ void checkEventTrue(uint8_t event_n)
 
 void checkCompoundEventTrue(uint8_t event_n)
 {
-    uint32_t active = readEeprom(event_n*8 + 0);
-    uint32_t event1 = readEeprom(event_n*8 + 1);
-    uint32_t event2 = readEeprom(event_n*8 + 2);
+    uint32_t active = readConfig(event_n*8 + 0);
+    uint32_t event1 = readConfig(event_n*8 + 1);
+    uint32_t event2 = readConfig(event_n*8 + 2);
 
     if (active != 1)
     {
@@ -243,325 +258,233 @@ void checkCompoundEventTrue(uint8_t event_n)
     }
 }
 
-playEvent(uint16_t event_n)
+// Returns the sensor a simple event is based on, 0xFF if it has none. A
+// compound event fires on whichever of its sub-events became true last, so
+// it is not attributed to a sensor and not timed.
+uint8_t getEventSensor(uint8_t event_n)
+{
+    uint32_t sensor;
+
+    if (event_n >= 16)
+    {
+        return 0xFF;
+    }
+    sensor = readConfig(event_n*8);
+    return (sensor <= 2) ? sensor : 0xFF;
+}
+
+// Reports a boot milestone, time is counted from when the PLL locked
+void reportBootTime(const char* label, uint32_t us)
 {
-    if (readEeprom(8*event_n + 3) == 0)
+    char str[48];
+
+    fmtStr(fmtU32(fmtStr(str, label), us, 0), " us\n");
+    putsUart0(str);
+}
+
+void playEvent(uint8_t event_n)
+{
+    uint8_t sensor = getEventSensor(event_n);
+
+    if (readConfig(8*event_n + 3) == 0)
     {
         return;
     }
 
     else
     {
-        uint8_t b;
-        for(b=1; b <= readEeprom(8*event_n + 4); b++)
+        if (sensor <= 2)
         {
-            setMotorSpeed(readEeprom(8*event_n + 7));
-            waitMicrosecond(1000*readEeprom(8*event_n + 5));
-            setMotorSpeed(0);
-            waitMicrosecond(1000*readEeprom(8*event_n + 6));
+            markEventDecision(sensor);
+        }
+        startPattern(eventPattern[event_n]);
+        sendHapticRecord(event_n, getEventPatternId(event_n));
+        if (bootFirstHaptic == 0)
+        {
+            bootFirstHaptic = getTimeUs();
+            reportBootTime("Boot: first haptic ", bootFirstHaptic);
         }
     }
 }
 
-int main(void)
+//-----------------------------------------------------------------------------
+// Tasks
+//-----------------------------------------------------------------------------
+
+// Streams and logs each completed acquisition frame
+void frameTask(void)
 {
-    waitMicrosecond(500000);
-    // Initialize hardware
-	initHw();
-	initUart0();
-	initPMW();
-	initEeprom();
+    toggleBlueLight();
+    lastFrame = frameCount;
+    sendSampleRecord(distance);
+    logSample(distance);
+    if (firstFrame)
+    {
+        firstFrame = false;
+        reportBootTime("Boot: first frame ", getTimeUs());
+    }
+}
 
-    // Setup UART0 baud rate
-    setUart0BaudRate(115200, 40e6);
+bool isFrameReady(void)
+{
+    return frameCount != lastFrame;
+}
 
-    //Enable Timers
-    EnableTrigTimer();
-    EnableWideTimer();
+// Re-evaluates the events after each new distance and starts the highest active pattern
+void eventTask(void)
+{
+    int8_t r;
 
-    setMotorSpeed(0);
-    if ( kbhitUart0() )
+    lastSample = sampleCount;
+
+    //Loop through the configuration to see if events 0-15 are true
+    for (r = 0; r < 16; r++)
     {
-        //getcUart0();
-        toggleGreenLight();
+        checkEventTrue(r);
     }
-    waitMicrosecond(500000);
 
-    while(1)
+    for (r = 16; r < 20; r++)
     {
-        toggleBlueLight();
-        //Loop through eeprom to see if events 0-15 are true
-        int8_t r;
-        for (r = 0; r < 16; r++)
-        {
-            checkEventTrue(r);
-        }
-
-        for (r = 16; r < 20; r++)
-        {
-            checkCompoundEventTrue(r);
-        }
+        checkCompoundEventTrue(r);
+    }
+    sendEventRecords(eventStatus, 20);
+    logEvents(eventStatus, 20);
 
-        //check for active event
-        for (r = 19; r >= 0; r--)
+    //check for active event, pattern plays in the background
+    for (r = 19; r >= 0; r--)
+    {
+        if (eventStatus[r] == 1)
         {
-            if (eventStatus[r] == 1)
+            if (!isHapticBusy())
             {
                 playEvent(r);
-                waitMicrosecond(1000000);
-                break;
             }
+            break;
         }
+    }
+    activeEvent = r;
+}
 
-        if ( kbhitUart0() )
-        {
-            USER_DATA data;
-            char str[50] = NULL;
+// Also released when the haptic holdoff ends while an event is still active
+bool isEventReady(void)
+{
+    return sampleCount != lastSample
+        || (activeEvent >= 0 && !isHapticBusy() && readConfig(8*activeEvent + 3) != 0);
+}
 
-            getsUart0(&data);
-            parseFields(&data);
+void displayTask(void)
+{
+    serviceDisplay(distance, eventStatus, 20);
+}
 
-            //help command
-            if (isCommand(&data, "help", 0))
-            {
-                putsUart0("reboot        (no params)\n");
-                putsUart0("event         EVENT SENSOR MIN_DIST_MM MAX_DIST_MM\n");
-                putsUart0("and           EVENT EVENT1 EVENT2\n");
-                putsUart0("erase         EVENT\n");
-                putsUart0("show events   (no params)\n");
-                putsUart0("show patterns (no params)\n");
-                putsUart0("haptic        EVENT on/off\n");
-                putsUart0("pattern       EVENT PWM BEATS ON_TIME OFF_TIME\n");
-                putsUart0("display       (no params)\n");
-            }
+void configTask(void)
+{
+    serviceConfig();
+}
 
-            //reboot command
-            if (isCommand(&data, "reboot", 0))
-            {
-                NVIC_APINT_R = NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ;
-            }
+bool isConfigReady(void)
+{
+    return getConfigPending() != 0;
+}
 
-            //update event MIN_MM and MAX_MM
-            if (isCommand(&data, "event", 4))
-            {
-                int32_t event_num = getFieldInteger(&data, 1);
-                int32_t sensor =    getFieldInteger(&data, 2);
-                int32_t min_mm =    getFieldInteger(&data, 3);
-                int32_t max_mm =    getFieldInteger(&data, 4);
-
-                if (event_num >=0 && event_num < 16)
-                {
-                    writeEeprom( (0 + 8*event_num), (uint32_t) sensor );
-                    writeEeprom( (1 + 8*event_num), (uint32_t) min_mm );
-                    writeEeprom( (2 + 8*event_num), (uint32_t) max_mm );
-                    snprintf(str, sizeof(str), "Distances for EVENT %2"PRIu32" entered.\n\n", event_num);
-                    putsUart0(str);
-                }
-
-                else if (event_num > 16 && event_num < 20)
-                {
-                    putsUart0("EVENTS 16-19 Reserved for compound Events (""and"" command)\n\n");
-                }
-
-                else
-                {
-                    putsUart0("Invalid Event number. Valid Events: 0-15\n\n");
-                }
-            }
+// Flash stalls every ISR (the vectors and handlers are in flash), so pages are
+// only written between an echo and the next trigger, with no pattern playing
+// and no UART input that could overrun the 16 byte RX FIFO
+bool isFlashQuiet(void)
+{
+    return phase == 2 && !isHapticBusy() && !isCliTransferPending() && isUart0RxIdle(FLASH_RX_QUIET_US);
+}
 
-            //compound event
-            if (isCommand(&data, "and", 3))
-            {
-                int8_t event_num = getFieldInteger(&data, 1);
-                int8_t event1 =    getFieldInteger(&data, 2);
-                int8_t event2 =    getFieldInteger(&data, 3);
-
-                if (event_num < 16)
-                {
-                    putsUart0("EVENTS 0-15 Reserved for single Events (""event"" command)\n\n");
-                }
-
-                else if (event_num > 19)
-                {
-                    putsUart0("Invalid Event number. Valid Compound Events: 16-19\n\n");
-                }
-
-                else
-                {
-                    writeEeprom( (0 + 8*event_num), (uint32_t) 1 );
-                    writeEeprom( (1 + 8*event_num), (uint32_t) event1 );
-                    writeEeprom( (2 + 8*event_num), (uint32_t) event2 );
-                    snprintf(str, sizeof(str), "Compound EVENT %2"PRIu32" entered.\n\n", event_num);
-                    putsUart0(str);
-                }
+void blackBoxTask(void)
+{
+    serviceBlackBox(isFlashQuiet());
+}
 
-            }
+bool isBlackBoxReady(void)
+{
+    return isBlackBoxDumping() || (isBlackBoxWritePending() && isFlashQuiet());
+}
 
-            //erase event
-            if (isCommand(&data, "erase", 1))
-            {
-                int8_t event_num = getFieldInteger(&data, 1);
-                if (event_num >=0 && event_num < 20)
-                {
-                    writeEeprom( (0 + 8*event_num), (uint32_t) -1 );
-                    snprintf(str, sizeof(str), "EVENT %2"PRIu32" erased.\n\n", event_num);
-                    putsUart0(str);
-                }
-
-                else
-                {
-                    putsUart0("Invalid Event number. Valid Events: 0-19\n\n");
-                }
-            }
+// Assembles CLI input as it arrives, never waiting for the rest of a line
+void cliTask(void)
+{
+    cliBusy = serviceBaudNegotiation() || serviceImport();
+    if (!cliBusy && getsUart0NonBlocking(&data))
+    {
+        parseFields(&data);
+        processCommand(&data);
+    }
+}
 
-            //show events or patterns
-            if (isCommand(&data, "show", 1))
-            {
-                char * str_show = getFieldString(&data, 1);
-
-                if (!strcmp(str_show,"events"))
-                {
-                    putsUart0("\nEVENT LIST\n");
-                    int i;
-                    for(i = 0; i < 16; i++)
-                    {
-                        char str0[40], str1[40], str2[40], str3[40] = NULL;
-                        uint16_t sensor_index = (uint16_t)(0+8*i);
-                        uint16_t min_index = (uint16_t)(1+8*i);
-                        uint16_t max_index = (uint16_t)(2+8*i);
-
-                        snprintf(str0, sizeof(str0), "EVENT %2"PRIu32"  ", i);
-                        putsUart0(str0);
-                        snprintf(str1, sizeof(str1), "SENSOR %2"PRId32"  ", (int32_t)readEeprom( sensor_index ));
-                        putsUart0(str1);
-                        snprintf(str2, sizeof(str2), "Min Distance: %4"PRIu32" mm  ", readEeprom( min_index ));
-                        putsUart0(str2);
-                        snprintf(str3, sizeof(str3), "Max Distance: %4"PRIu32" mm\n", readEeprom( max_index ));
-                        putsUart0(str3);
-                    }
-                    putsUart0("\n");
-
-                    putsUart0("COMPOUND EVENTS\n");
-                    for(i = 16; i < 20; i++)
-                    {
-                        char str0[40], str1[40], str2[40], str3[40] = NULL;
-                        uint16_t active = (uint16_t)(0+8*i);
-                        uint16_t event1 = (uint16_t)(1+8*i);
-                        uint16_t event2 = (uint16_t)(2+8*i);
-
-
-                        snprintf(str0, sizeof(str0), "EVENT %2"PRIu32"  ", i);
-                        putsUart0(str0);
-                        snprintf(str1, sizeof(str1), "ACTIVE %2"PRId32"  ", (int32_t)readEeprom( active ));
-                        putsUart0(str1);
-                        snprintf(str2, sizeof(str2), "EVENT %2"PRIu32" AND ", readEeprom( event1 ));
-                        putsUart0(str2);
-                        snprintf(str3, sizeof(str3), "EVENT %2"PRIu32"\n", readEeprom( event2 ));
-                        putsUart0(str3);
-                    }
-                    putsUart0("\n");
-
-                }
-
-                else if (!strcmp(str_show,"patterns"))
-                {
-                    putsUart0("\nPATTERN LIST\n");
-                    int i;
-                    for(i = 0; i < 20; i++)
-                    {
-                        char str0[40], str1[40], str2[40], str3[40], str4[40], str5[40] = NULL;
-                        uint16_t haptic_index =  (uint16_t)(3+8*i);
-                        uint16_t beat_index =    (uint16_t)(4+8*i);
-                        uint16_t ontime_index =  (uint16_t)(5+8*i);
-                        uint16_t offtime_index = (uint16_t)(6+8*i);
-                        uint16_t pwm_index =     (uint16_t)(7+8*i);
-
-                        snprintf(str0, sizeof(str0), "EVENT %2"PRIu32"  ", i);
-                        putsUart0(str0);
-                        snprintf(str1, sizeof(str1), "Haptics: %1"PRIu32" (on = 1/off = 0)  ", readEeprom( haptic_index ));
-                        putsUart0(str1);
-                        snprintf(str5, sizeof(str5), "PWM: %3"PRIu32"%%  ", readEeprom( pwm_index ));
-                        putsUart0(str5);
-                        snprintf(str2, sizeof(str2), "Beat Count: %2"PRIu32"  ", readEeprom( beat_index ));
-                        putsUart0(str2);
-                        snprintf(str3, sizeof(str3), "Time on: %4"PRIu32" ms  ", readEeprom( ontime_index ));
-                        putsUart0(str3);
-                        snprintf(str4, sizeof(str4), "Time off: %4"PRIu32" ms  \n", readEeprom( offtime_index ));
-                        putsUart0(str4);
-                    }
-                    putsUart0("\n");
-                }
-            }
+bool isCliReady(void)
+{
+    return cliBusy || kbhitUart0();
+}
 
-            //update haptic
-            if (isCommand(&data, "haptic", 2))
-            {
-                int8_t event_num = getFieldInteger(&data, 1);
-                char*  str =       getFieldString(&data, 2);
-
-                //if haptic set to "on"
-                if (!strcmp(str,"on"))
-                {
-                    writeEeprom( (3 + 8*event_num), (uint32_t) 1 );
-                    putsUart0("Haptic is on.\n\n");
-                }
-
-                else if (!strcmp(str,"off"))
-                {
-                    writeEeprom( (3 + 8*event_num), (uint32_t) 0 );
-                    putsUart0("Haptic is off.\n\n");
-                }
-            }
+// Warns once when the stack reaches its guard words, before it runs into .bss
+void stackTask(void)
+{
+    if (!stackWarned && !isStackGuardIntact())
+    {
+        stackWarned = true;
+        putsUart0("Warning: stack guard overwritten, see mem command.\n");
+    }
+}
 
-            //update pattern
-            if (isCommand(&data, "pattern", 5))
-            {
-                int8_t   event_num =   getFieldInteger(&data, 1);
-                int8_t   pwm =         getFieldInteger(&data, 2);
-                int8_t   beats =       getFieldInteger(&data, 3);
-                int32_t  ms_on_time =  getFieldInteger(&data, 4);
-                int32_t  ms_off_time = getFieldInteger(&data, 5);
-
-                uint16_t beat_index =    (uint16_t)(4+8*event_num);
-                uint16_t ontime_index =  (uint16_t)(5+8*event_num);
-                uint16_t offtime_index = (uint16_t)(6+8*event_num);
-                uint16_t pwm_index =     (int16_t)(7+8*event_num);
-
-                if (event_num >=0 && event_num < 20)
-                {
-                    char str10[50] = NULL;
-                    writeEeprom( pwm_index, (uint32_t) pwm );
-                    writeEeprom( beat_index, (uint32_t) beats );
-                    writeEeprom( ontime_index, (uint32_t) ms_on_time );
-                    writeEeprom( offtime_index, (uint32_t) ms_off_time );
-                    snprintf(str10, sizeof(str10), "Patterns for EVENT %2"PRId32" entered.\n", event_num);
-                    putsUart0(str10);
-                }
-
-                else
-                {
-                    putsUart0("Invalid Event number. Valid Events: 0-19\n");
-                }
-
-                putsUart0("\n");
-            }
+int main(void)
+{
+    // Paint the stack before any deeper frames exist
+    paintStack();
 
-            if (isCommand(&data, "display", 0))
-            {
-                while( !kbhitUart0() )
-                {
-                    snprintf(str, sizeof(str), "Sensor 0:    %5"PRIu32" (mm)\n", distance[0]);
-                    putsUart0(str);
-                    snprintf(str, sizeof(str), "Sensor 1:    %5"PRIu32" (mm)\n", distance[1]);
-                    putsUart0(str);
-                    snprintf(str, sizeof(str), "Sensor 2:    %5"PRIu32" (mm)\n\n\n", distance[2]);
-                    putsUart0(str);
-                    waitMicrosecond(100000);
-                }
-            }
+    // Initialize hardware, each step waits only for its own peripheral ready bits
+	initHw();
+	initTimeBase();
+	initPerf();
+	initLatency();
+	initUart0();
+	initPMW();
+	initEeprom();
+	initConfig();
+	initHaptic();
+	initBlackBox();
+	initPower();
+	initScheduler();
+	loadEventPatterns();
 
-        }
+    // Setup UART0 baud rate
+    setUart0BaudRate(115200, SYSTEM_CLOCK_HZ);
+    if (configStatus == CONFIG_DEFAULTED)
+    {
+        putsUart0("Configuration corrupt, default profile loaded.\n");
+    }
+
+    // Tasks in priority order: name, run, ready check, period (ms), deadline (us)
+    addTask("events",   eventTask,    isEventReady,    0,  500);
+    addTask("frame",    frameTask,    isFrameReady,    0,  2000);
+    addTask("blackbox", blackBoxTask, isBlackBoxReady, 0,  5000);
+    addTask("cli",      cliTask,      isCliReady,      0,  20000);
+    setDisplayTask(addTask("display", displayTask, 0, 0, 5000));   // period set by the display command
+    addTask("config",   configTask,   isConfigReady,   0,  1000);
+    addTask("stack",    stackTask,    0,               1000, 200);
+
+    //Enable Timers
+    EnableWideTimer();
+    EnableTrigTimer();
+    reportBootTime("Boot: ready ", getTimeUs());
+
+    //start the first frame now rather than one timer period from now
+    NVIC_SW_TRIG_R = INT_TIMER4A - 16;
+
+    setMotorSpeed(0);
+    if ( kbhitUart0() )
+    {
+        //getcUart0();
+        toggleGreenLight();
     }
 
+    //the frame started above is incomplete, stream from the next one
+    lastFrame = frameCount;
+    runScheduler();
+
     return 0;
 }
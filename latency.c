@@ -0,0 +1,164 @@
+// Echo-to-Vibration Latency Instrumentation
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Optional debug outputs (build with LATENCY_GPIO):
+//   PB0 toggles on echo capture, PB1 on event decision, PB2 on PWM enable
+
+// Timestamps come from PERF_CYCLES() (perf.c). A capture is only measured
+// once: the first decision made from it and the PWM enable that follows are
+// binned, later decisions reuse newer captures.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "latency.h"
+#include "clock.h"
+#include "perf.h"
+
+#ifndef HOST_SIM
+#include "tm4c123gh6pm.h"
+#endif
+
+#define CYCLE_COUNT PERF_CYCLES()
+
+#if defined(LATENCY_GPIO) && !defined(HOST_SIM)
+#define DEBUG_0  (*((volatile uint32_t *)(0x42000000 + (0x400053FC-0x40000000)*32 + 0*4))) //PB0
+#define DEBUG_1  (*((volatile uint32_t *)(0x42000000 + (0x400053FC-0x40000000)*32 + 1*4))) //PB1
+#define DEBUG_2  (*((volatile uint32_t *)(0x42000000 + (0x400053FC-0x40000000)*32 + 2*4))) //PB2
+#define DEBUG_MASK 7
+#define TOGGLE(pin) (pin ^= 1)
+#else
+#define TOGGLE(pin)
+#endif
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+LATENCY_STATS latencyStats[2];
+uint32_t captureLatencyMax[3];
+
+static volatile uint32_t captureTime[3];
+static volatile bool captureFresh[3];
+static uint32_t decisionCapture;
+static bool pwmPending;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initLatency(void)
+{
+#if defined(LATENCY_GPIO) && !defined(HOST_SIM)
+    SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R1;
+    _delay_cycles(3);
+    GPIO_PORTB_DIR_R |= DEBUG_MASK;
+    GPIO_PORTB_DEN_R |= DEBUG_MASK;
+#endif
+    resetLatency();
+}
+
+uint32_t latencyTimestamp(void)
+{
+    return CYCLE_COUNT;
+}
+
+// Adds cycles the counter missed (the core clock is gated during sleep)
+void adjustLatencyTimestamp(uint32_t cycles)
+{
+    CYCLE_COUNT += cycles;
+}
+
+void resetLatency(void)
+{
+    uint8_t i, b;
+    for (i = 0; i < 2; i++)
+    {
+        latencyStats[i].count = 0;
+        latencyStats[i].minUs = 0xFFFFFFFF;
+        latencyStats[i].maxUs = 0;
+        for (b = 0; b < LATENCY_BINS; b++)
+        {
+            latencyStats[i].bin[b] = 0;
+        }
+    }
+    for (i = 0; i < 3; i++)
+    {
+        captureLatencyMax[i] = 0;
+    }
+    pwmPending = false;
+}
+
+static void addSample(LATENCY_STATS* stats, uint32_t cycles)
+{
+    uint32_t us = cycles / CYCLES_PER_US;
+    uint8_t b = 0;
+
+    while ((b < LATENCY_BINS-1) && (us >> b) != 0)
+    {
+        b++;
+    }
+
+    stats->bin[b]++;
+    stats->count++;
+    if (us < stats->minUs) stats->minUs = us;
+    if (us > stats->maxUs) stats->maxUs = us;
+}
+
+// Called from the wide timer ISRs on every edge with the cycles since the edge was latched
+void noteCaptureLatency(uint8_t channel, uint32_t cycles)
+{
+    if (cycles > captureLatencyMax[channel])
+    {
+        captureLatencyMax[channel] = cycles;
+    }
+}
+
+// Called from the wide timer ISRs on the falling (echo end) edge
+void markEchoCapture(uint8_t channel)
+{
+    captureTime[channel] = CYCLE_COUNT;
+    captureFresh[channel] = true;
+    TOGGLE(DEBUG_0);
+}
+
+// Called when an event based on this channel starts a pattern
+void markEventDecision(uint8_t channel)
+{
+    uint32_t now = CYCLE_COUNT;
+
+    TOGGLE(DEBUG_1);
+    if (channel > 2 || !captureFresh[channel])
+    {
+        return;
+    }
+
+    captureFresh[channel] = false;
+    decisionCapture = captureTime[channel];
+    addSample(&latencyStats[LATENCY_DECISION], now - decisionCapture);
+    pwmPending = true;
+}
+
+// Called by the haptic sequencer when the motor is first driven
+void markPwmEnable(void)
+{
+    uint32_t now = CYCLE_COUNT;
+
+    TOGGLE(DEBUG_2);
+    if (pwmPending)
+    {
+        pwmPending = false;
+        addSample(&latencyStats[LATENCY_PWM], now - decisionCapture);
+    }
+}
@@ -0,0 +1,50 @@
+// Echo-to-Vibration Latency Instrumentation
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Optional debug outputs (build with LATENCY_GPIO):
+//   PB0 toggles on echo capture, PB1 on event decision, PB2 on PWM enable
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LATENCY_BINS 24             // bin N counts latencies below 2^N us
+
+#define LATENCY_DECISION 0          // echo capture to event decision
+#define LATENCY_PWM      1          // echo capture to PWM enable
+
+typedef struct _LATENCY_STATS
+{
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t bin[LATENCY_BINS];
+} LATENCY_STATS;
+
+extern LATENCY_STATS latencyStats[2];
+extern uint32_t captureLatencyMax[3];   // worst echo edge to ISR delay per channel, in cycles
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initLatency(void);
+uint32_t latencyTimestamp(void);
+void adjustLatencyTimestamp(uint32_t cycles);
+void noteCaptureLatency(uint8_t channel, uint32_t cycles);
+void markEchoCapture(uint8_t channel);
+void markEventDecision(uint8_t channel);
+void markPwmEnable(void);
+void resetLatency(void);
+
+#endif
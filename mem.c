@@ -0,0 +1,90 @@
+// Stack and RAM Usage
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// The stack is only 512 bytes (__STACK_TOP in tm4c123gh6pm.cmd), so the free
+// part of it is painted with STACK_PAINT first thing in main(). The deepest
+// point ever reached is then the lowest word no longer holding the paint.
+// The stack grows down towards the other SRAM sections, so the lowest
+// STACK_GUARD_WORDS act as a guard that is checked before an overflow reaches
+// them. Section sizes come from symbols added to the linker command file.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mem.h"
+
+// Linker symbols, only their addresses are meaningful
+extern uint32_t __stack;
+extern uint32_t __STACK_TOP;
+extern uint32_t __DATA_START;
+extern uint32_t __DATA_END;
+extern uint32_t __BSS_START;
+extern uint32_t __BSS_END;
+extern uint32_t __SYSMEM_START;
+extern uint32_t __SYSMEM_END;
+
+// Words left unpainted below the caller of paintStack(), covers its own frame
+#define PAINT_MARGIN_WORDS  16
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// Must run before anything else in main() so no live frame is below this one
+void paintStack(void)
+{
+    volatile uint32_t here;
+    uint32_t* p = &__stack;
+    uint32_t* end = (uint32_t*)&here - PAINT_MARGIN_WORDS;
+
+    while (p < end)
+    {
+        *p++ = STACK_PAINT;
+    }
+}
+
+// Returns the deepest stack use since boot in bytes
+uint32_t getStackUsed(void)
+{
+    uint32_t* p = &__stack;
+
+    while (p < &__STACK_TOP && *p == STACK_PAINT)
+    {
+        p++;
+    }
+    return (uint32_t)&__STACK_TOP - (uint32_t)p;
+}
+
+bool isStackGuardIntact(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < STACK_GUARD_WORDS; i++)
+    {
+        if ((&__stack)[i] != STACK_PAINT)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void getMemUsage(MEM_USAGE* usage)
+{
+    usage->dataBytes = (uint32_t)&__DATA_END - (uint32_t)&__DATA_START;
+    usage->bssBytes = (uint32_t)&__BSS_END - (uint32_t)&__BSS_START;
+    usage->heapBytes = (uint32_t)&__SYSMEM_END - (uint32_t)&__SYSMEM_START;
+    usage->stackBytes = (uint32_t)&__STACK_TOP - (uint32_t)&__stack;
+    usage->stackUsed = getStackUsed();
+    usage->sramFree = SRAM_SIZE - usage->dataBytes - usage->bssBytes - usage->heapBytes - usage->stackBytes;
+}
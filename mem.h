@@ -0,0 +1,40 @@
+// Stack and RAM Usage
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+#ifndef MEM_H_
+#define MEM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SRAM_SIZE           0x8000      // matches SRAM in tm4c123gh6pm.cmd
+#define STACK_PAINT         0xA5A5A5A5
+#define STACK_GUARD_WORDS   16          // lowest 64 bytes, touched means nearly out of stack
+
+typedef struct _MEM_USAGE
+{
+    uint32_t dataBytes;
+    uint32_t bssBytes;
+    uint32_t heapBytes;
+    uint32_t stackBytes;
+    uint32_t stackUsed;                 // high-water mark since boot
+    uint32_t sramFree;
+} MEM_USAGE;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void paintStack(void);
+uint32_t getStackUsed(void);
+bool isStackGuardIntact(void);
+void getMemUsage(MEM_USAGE* usage);
+
+#endif
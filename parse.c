@@ -0,0 +1,206 @@
+// Command Line Parsing
+// Jason Losh
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+// Splits a line from getsUart0 into alpha and numeric fields in place.
+// Fields are read as views into USER_DATA.buffer (pointer + length) and
+// integers are parsed in place, so nothing is copied and the returned
+// pointers stay valid as long as the USER_DATA does.
+// Has no hardware dependencies so host tools can link it.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "parse.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void parseFields(USER_DATA * data)
+{
+    int index = 0;
+    int dataIndex = 0;
+
+    data->fieldCount = 0;
+
+    char previous = 'd';
+    char current = 'x';
+
+    //Loops through buffer until NULL terminator is reached
+    while(data->buffer[index] != '\0')
+    {
+
+        char c = data->buffer[index];
+
+        //If char is alpha, ('a'-'z') || ('A'-'Z') ==> fieldType = 'a'
+        if( ((c >= 97) && (c <= 122)) || ((c >= 65) &&  (c <= 90)) )
+        {
+            current = 'a';
+            index++;
+        }
+
+        //If char is numeric, ('0'-'9') || '-' || '.' ==> fieldType = 'n'
+        else if ( ((c >= 48) && (c <= 57)) || (c == 45) ||  (c == 46) )
+        {
+            current = 'n';
+            index++;
+        }
+
+        //Else char is a delimiter ==> fieldType = 'd'
+        //Set previous to d in order to continue through string
+        //replace delimiters with NULL character
+        else
+        {
+            current = 'd';
+            previous = 'd';
+            data->buffer[index] = '\0';
+            index++;
+        }
+
+        //Occurs when transition from 'd' to 'a' OR 'd' to 'n'
+        //Fields past MAX_FIELDS are ignored but still terminated
+        if((current != previous) && (previous == 'd'))
+        {
+            if ((data->fieldCount) < MAX_FIELDS)
+            {
+                //Increment Field Count
+                (data->fieldCount)++;
+
+                //Stores the fieldType of Transition
+                data->fieldType[dataIndex] = current;
+
+                //Stores fieldPosition of Transition and increments dataIndex
+                data->fieldPosition[dataIndex] = (index-1);
+
+                dataIndex++;
+            }
+
+            //Updates previous c
+            previous = current;
+        }
+    }
+
+    //Stores the length of each field now that all are terminated
+    for (dataIndex = 0; dataIndex < data->fieldCount; dataIndex++)
+    {
+        data->fieldLength[dataIndex] = strlen(&data->buffer[data->fieldPosition[dataIndex]]);
+    }
+}
+
+// Returns a view of a field inside data->buffer, false if the field does not exist
+bool getField(USER_DATA * data, uint8_t fieldNumber, FIELD * field)
+{
+    if (fieldNumber >= data->fieldCount)
+    {
+        return false;
+    }
+
+    field->ptr = &data->buffer[data->fieldPosition[fieldNumber]];
+    field->length = data->fieldLength[fieldNumber];
+    return true;
+}
+
+// Returns the alpha field in place (terminated by parseFields), or NULL if missing or numeric
+const char* getFieldString(USER_DATA * data, uint8_t fieldNumber)
+{
+    if ( (fieldNumber >= (data->fieldCount)) || ((data->fieldType[fieldNumber]) == 'n') )
+    {
+        return NULL;
+    }
+    return &data->buffer[data->fieldPosition[fieldNumber]];
+}
+
+// Compares a field with a string without copying either
+bool isFieldString(USER_DATA * data, uint8_t fieldNumber, const char str[])
+{
+    FIELD field;
+    uint8_t i;
+
+    if (!getField(data, fieldNumber, &field))
+    {
+        return false;
+    }
+
+    for (i = 0; i < field.length; i++)
+    {
+        if (field.ptr[i] != str[i])
+        {
+            return false;
+        }
+    }
+    return str[i] == '\0';
+}
+
+// Parses a numeric field in place, returns false if it is missing, not an
+// integer or outside min..max
+bool getFieldRange(USER_DATA * data, uint8_t fieldNumber, int32_t min, int32_t max, int32_t * value)
+{
+    FIELD field;
+    bool negative = false;
+    int64_t result = 0;
+    uint8_t i = 0;
+
+    if (!getField(data, fieldNumber, &field) || data->fieldType[fieldNumber] != 'n')
+    {
+        return false;
+    }
+
+    if (field.ptr[0] == '-')
+    {
+        negative = true;
+        i++;
+    }
+    if (i == field.length)
+    {
+        return false;
+    }
+
+    for (; i < field.length; i++)
+    {
+        char c = field.ptr[i];
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+        result = result*10 + (c - '0');
+        if (result > (int64_t)INT32_MAX + 1)
+        {
+            return false;
+        }
+    }
+
+    if (negative)
+    {
+        result = -result;
+    }
+    if (result < min || result > max)
+    {
+        return false;
+    }
+    *value = (int32_t)result;
+    return true;
+}
+
+// Returns the numeric field as an integer, 0 if missing or invalid
+int32_t getFieldInteger(USER_DATA * data, uint8_t fieldNumber)
+{
+    int32_t value;
+
+    if (!getFieldRange(data, fieldNumber, INT32_MIN, INT32_MAX, &value))
+    {
+        return 0;
+    }
+    return value;
+}
@@ -0,0 +1,48 @@
+// Command Line Parsing
+// Jason Losh
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM (also builds on the host tools)
+// System Clock:    -
+
+#ifndef PARSE_H_
+#define PARSE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MAX_CHARS 80
+#define MAX_FIELDS 7
+
+typedef struct _USER_DATA
+{
+    char buffer[MAX_CHARS+1];
+    uint8_t lineCount;                  // characters of the line getsUart0NonBlocking is assembling
+    uint8_t fieldCount;
+    uint8_t fieldPosition[MAX_FIELDS];
+    uint8_t fieldLength[MAX_FIELDS];
+    char fieldType[MAX_FIELDS];
+} USER_DATA;
+
+// View of one field inside USER_DATA.buffer
+typedef struct _FIELD
+{
+    const char* ptr;
+    uint8_t length;
+} FIELD;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void parseFields(USER_DATA * data);
+bool getField(USER_DATA * data, uint8_t fieldNumber, FIELD * field);
+const char* getFieldString(USER_DATA * data, uint8_t fieldNumber);
+bool isFieldString(USER_DATA * data, uint8_t fieldNumber, const char str[]);
+bool getFieldRange(USER_DATA * data, uint8_t fieldNumber, int32_t min, int32_t max, int32_t * value);
+int32_t getFieldInteger(USER_DATA * data, uint8_t fieldNumber);
+
+#endif
@@ -0,0 +1,185 @@
+// Haptic Pattern Library
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// Patterns are lists of delta-encoded steps kept in flash. Each event stores
+// only a pattern ID in the configuration (words 160-179); ID 0 selects the event's own
+// beat/on/off/pwm words, which are converted once into a two step pattern.
+// Events resolve to a pattern pointer at load time, so changing the pattern
+// of an event is a pointer swap.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pattern.h"
+#include "config.h"
+
+//-----------------------------------------------------------------------------
+// Pattern library (flash)
+//-----------------------------------------------------------------------------
+
+static const PATTERN_STEP tapSteps[] =       { {100, 10}, {-100, 10} };
+static const PATTERN_STEP doubleSteps[] =    { {100, 8}, {-100, 8}, {100, 8}, {-100, 30} };
+static const PATTERN_STEP rampUpSteps[] =    { {20, 10}, {20, 10}, {20, 10}, {20, 10}, {20, 10}, {-100, 20} };
+static const PATTERN_STEP rampDownSteps[] =  { {100, 10}, {-20, 10}, {-20, 10}, {-20, 10}, {-20, 10}, {-20, 20} };
+static const PATTERN_STEP heartbeatSteps[] = { {90, 6}, {-90, 6}, {60, 6}, {-60, 40} };
+static const PATTERN_STEP alarmSteps[] =     { {100, 5}, {-100, 5} };
+static const PATTERN_STEP waveSteps[] =      { {25, 8}, {25, 8}, {25, 8}, {25, 8}, {-25, 8}, {-25, 8}, {-25, 8}, {-25, 8} };
+static const PATTERN_STEP longSteps[] =      { {100, 100}, {-100, 50} };
+
+#define STEPS(s) (sizeof(s)/sizeof(PATTERN_STEP)), (s)
+
+// ID 0 is reserved for the legacy per-event pattern
+static const PATTERN patternLibrary[] =
+{
+    { "legacy",    1,  0, 0, 0 },
+    { "tap",       10, 1, STEPS(tapSteps) },
+    { "double",    10, 1, STEPS(doubleSteps) },
+    { "ramp up",   10, 1, STEPS(rampUpSteps) },
+    { "ramp down", 10, 1, STEPS(rampDownSteps) },
+    { "heartbeat", 10, 2, STEPS(heartbeatSteps) },
+    { "alarm",     10, 6, STEPS(alarmSteps) },
+    { "wave",      10, 2, STEPS(waveSteps) },
+    { "long",      10, 1, STEPS(longSteps) },
+};
+
+#define PATTERN_COUNT (sizeof(patternLibrary)/sizeof(PATTERN))
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+const PATTERN* eventPattern[MAX_EVENTS];
+
+// RAM patterns built from the legacy EEPROM words 4-7
+static PATTERN legacyPattern[MAX_EVENTS];
+static PATTERN_STEP legacySteps[MAX_EVENTS][2];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint8_t getPatternCount(void)
+{
+    return PATTERN_COUNT;
+}
+
+const PATTERN* getLibraryPattern(uint8_t id)
+{
+    if (id >= PATTERN_COUNT)
+    {
+        return 0;
+    }
+    return &patternLibrary[id];
+}
+
+// Returns the pattern ID of an event, treating erased EEPROM as legacy
+uint32_t getEventPatternId(uint8_t event_n)
+{
+    uint32_t id = readConfig(PATTERN_ID_ADD + event_n);
+
+    if (id >= PATTERN_COUNT)
+    {
+        id = PATTERN_LEGACY;
+    }
+    return id;
+}
+
+// Picks the smallest unit (1, 10 or 100 ms) that holds both times in a byte
+static uint8_t getLegacyUnit(uint32_t on_ms, uint32_t off_ms)
+{
+    uint32_t longest = (on_ms > off_ms) ? on_ms : off_ms;
+
+    if (longest <= 255)
+    {
+        return 1;
+    }
+    else if (longest <= 2550)
+    {
+        return 10;
+    }
+    return 100;
+}
+
+static uint8_t toUnits(uint32_t ms, uint8_t unit)
+{
+    uint32_t units = (ms + unit/2) / unit;
+    return (units > 255) ? 255 : units;
+}
+
+static void buildLegacyPattern(uint8_t event_n)
+{
+    uint32_t beats =  readConfig(8*event_n + 4);
+    uint32_t on_ms =  readConfig(8*event_n + 5);
+    uint32_t off_ms = readConfig(8*event_n + 6);
+    uint32_t pwm =    readConfig(8*event_n + 7);
+    uint8_t  unit =   getLegacyUnit(on_ms, off_ms);
+
+    if (pwm > 100)
+    {
+        pwm = 100;
+    }
+
+    legacySteps[event_n][0].pwmDelta = pwm;
+    legacySteps[event_n][0].duration = toUnits(on_ms, unit);
+    legacySteps[event_n][1].pwmDelta = -(int8_t)pwm;
+    legacySteps[event_n][1].duration = toUnits(off_ms, unit);
+
+    legacyPattern[event_n].name = patternLibrary[PATTERN_LEGACY].name;
+    legacyPattern[event_n].unitMs = unit;
+    legacyPattern[event_n].repeat = (beats > 255) ? 255 : beats;
+    legacyPattern[event_n].stepCount = 2;
+    legacyPattern[event_n].steps = legacySteps[event_n];
+}
+
+// Resolves the pattern pointer of one event from the configuration
+void loadEventPattern(uint8_t event_n)
+{
+    uint32_t id = getEventPatternId(event_n);
+
+    if (id == PATTERN_LEGACY)
+    {
+        buildLegacyPattern(event_n);
+        eventPattern[event_n] = &legacyPattern[event_n];
+    }
+    else
+    {
+        eventPattern[event_n] = &patternLibrary[id];
+    }
+}
+
+void loadEventPatterns(void)
+{
+    uint8_t i;
+    for (i = 0; i < MAX_EVENTS; i++)
+    {
+        loadEventPattern(i);
+    }
+}
+
+// Stores a new pattern ID for an event and swaps its pattern pointer
+bool selectEventPattern(uint8_t event_n, uint32_t id)
+{
+    if (event_n >= MAX_EVENTS || id >= PATTERN_COUNT)
+    {
+        return false;
+    }
+
+    writeConfig(PATTERN_ID_ADD + event_n, id);
+
+    //a staged ID takes effect when the transaction is committed
+    if (!isConfigStaging())
+    {
+        loadEventPattern(event_n);
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+// Haptic Pattern Library
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+#ifndef PATTERN_H_
+#define PATTERN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MAX_EVENTS          20
+#define PATTERN_LEGACY      0       // pattern ID 0 plays the event's own words 4-7
+#define PATTERN_ID_ADD      160     // EEPROM word holding the pattern ID of event 0
+
+// One step of a pattern, delta-encoded against the previous step's PWM
+typedef struct _PATTERN_STEP
+{
+    int8_t  pwmDelta;               // change in PWM duty (%) from the previous step
+    uint8_t duration;               // time the step is held, in units of unitMs
+} PATTERN_STEP;
+
+typedef struct _PATTERN
+{
+    const char* name;
+    uint8_t unitMs;                 // length of one duration unit (ms)
+    uint8_t repeat;                 // number of times the step list is played
+    uint8_t stepCount;
+    const PATTERN_STEP* steps;
+} PATTERN;
+
+extern const PATTERN* eventPattern[MAX_EVENTS];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+uint8_t getPatternCount(void);
+const PATTERN* getLibraryPattern(uint8_t id);
+uint32_t getEventPatternId(uint8_t event_n);
+void loadEventPattern(uint8_t event_n);
+void loadEventPatterns(void);
+bool selectEventPattern(uint8_t event_n, uint32_t id);
+
+#endif
@@ -0,0 +1,90 @@
+// Cycle Counter Profiling
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Owns the Cortex-M4 DWT cycle counter. Code under test is bracketed with
+// start = PERF_BEGIN() and PERF_END(probe, start), which keep count, min, max
+// and total cycles per probe. ISRs are probed in their handlers, loop stages
+// by the scheduler around each task. Profiling starts off and is switched
+// with the perf command. Building with HOST_SIM replaces the counter with
+// simCycleCount so the same code runs in a host simulation.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "perf.h"
+#ifndef HOST_SIM
+#include "tm4c123gh6pm.h"
+#endif
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+#ifdef HOST_SIM
+uint32_t simCycleCount;
+#endif
+
+volatile bool perfEnabled = false;
+PERF_STATS perfStats[PERF_PROBES];
+
+static const char* probeNames[PERF_PROBES] = { "capture", "trigger", "pulse", "haptic", "uart" };
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initPerf(void)
+{
+#ifndef HOST_SIM
+    NVIC_DBG_INT_R |= DEMCR_TRCENA;                  // enable trace block (DEMCR)
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;                // start cycle counter
+#endif
+    resetPerf();
+}
+
+// Called from PERF_END(), also from ISRs, so a sample racing a reset may be lost
+void recordPerf(uint8_t probe, uint32_t cycles)
+{
+    PERF_STATS* stats = &perfStats[probe];
+
+    stats->count++;
+    stats->totalCycles += cycles;
+    if (cycles < stats->minCycles) stats->minCycles = cycles;
+    if (cycles > stats->maxCycles) stats->maxCycles = cycles;
+}
+
+void resetPerf(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PERF_PROBES; i++)
+    {
+        perfStats[i].count = 0;
+        perfStats[i].minCycles = 0xFFFFFFFF;
+        perfStats[i].maxCycles = 0;
+        perfStats[i].totalCycles = 0;
+    }
+}
+
+// Loop stages are named by the scheduler as tasks are added
+void setPerfName(uint8_t probe, const char* name)
+{
+    probeNames[probe] = name;
+}
+
+// Returns 0 for a stage with no task
+const char* getPerfName(uint8_t probe)
+{
+    return probeNames[probe];
+}
@@ -0,0 +1,65 @@
+// Cycle Counter Profiling
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+#ifndef PERF_H_
+#define PERF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sched.h"
+
+// Probes, ISRs first then one loop stage per scheduler task
+#define PERF_CAPTURE    0           // wide timer echo captures
+#define PERF_TRIGGER    1           // trigger timer
+#define PERF_PULSE      2           // trigger pulse end
+#define PERF_HAPTIC     3           // haptic step timer
+#define PERF_UART       4           // UART0 RX and TX DMA
+#define PERF_STAGE      5           // + task id
+#define PERF_PROBES     (PERF_STAGE + MAX_TASKS)
+
+#ifdef HOST_SIM
+extern uint32_t simCycleCount;
+#define PERF_CYCLES()   (simCycleCount)
+#else
+// DWT registers (not in tm4c123gh6pm.h)
+#define DWT_CTRL_R      (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R    (*((volatile uint32_t *)0xE0001004))
+#define DWT_CTRL_CYCCNTENA 0x00000001
+#define DEMCR_TRCENA       0x01000000
+#define PERF_CYCLES()   (DWT_CYCCNT_R)
+#endif
+
+// uint32_t start = PERF_BEGIN(); ... PERF_END(probe, start);
+// Costs one counter read and a flag test while profiling is off
+#define PERF_BEGIN()            PERF_CYCLES()
+#define PERF_END(probe, start)  do { if (perfEnabled) recordPerf(probe, PERF_CYCLES() - (start)); } while (0)
+
+typedef struct _PERF_STATS
+{
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+} PERF_STATS;
+
+extern volatile bool perfEnabled;
+extern PERF_STATS perfStats[PERF_PROBES];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initPerf(void);
+void recordPerf(uint8_t probe, uint32_t cycles);
+void resetPerf(void);
+void setPerfName(uint8_t probe, const char* name);
+const char* getPerfName(uint8_t probe);
+
+#endif
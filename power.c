@@ -0,0 +1,124 @@
+// Low Power Idle
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// The scheduler sleeps with WFI whenever no task is released. It masks
+// interrupts with beginIdle(), checks for work, and only then calls
+// sleepIdle(). A pending interrupt still ends WFI while masked, so one that
+// arrives after the check is not lost, its ISR just runs at endIdle().
+// With auto clock gating (RCC ACG) the SCGC registers pick the clocks that
+// stay on in sleep. They are rebuilt before each sleep so uDMA and the EEPROM
+// are only clocked while a transfer or write is in flight.
+// The DWT cycle counter can stop while the core is gated, so each sleep is
+// also timed with the time base (timebase.c) and the difference is added
+// back to keep latencyTimestamp() continuous.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "power.h"
+#include "latency.h"
+#include "timebase.h"
+#include "clock.h"
+#include "uart0.h"
+#include "eeprom.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+uint32_t powerWakes = 0;
+static uint64_t lastWake;
+static uint32_t windowWakes;
+static uint64_t busyCycles;
+static uint64_t sleepCycles;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initPower(void)
+{
+    NVIC_SYS_CTRL_R &= ~(NVIC_SYS_CTRL_SLEEPDEEP | NVIC_SYS_CTRL_SLEEPEXIT);
+    SYSCTL_RCC_R |= SYSCTL_RCC_ACG;                                 // sleep uses the SCGC registers
+
+    // Clocks that can wake the CPU or drive outputs stay on in sleep
+    SYSCTL_SCGCTIMER_R = SYSCTL_SCGCTIMER_S0 | SYSCTL_SCGCTIMER_S1 | SYSCTL_SCGCTIMER_S2 | SYSCTL_SCGCTIMER_S4;
+    SYSCTL_SCGCWTIMER_R = SYSCTL_SCGCWTIMER_S1 | SYSCTL_SCGCWTIMER_S2 | SYSCTL_SCGCWTIMER_S3 | SYSCTL_SCGCWTIMER_S4
+                        | SYSCTL_SCGCWTIMER_S5;
+    SYSCTL_SCGCGPIO_R = SYSCTL_SCGCGPIO_S0 | SYSCTL_SCGCGPIO_S2 | SYSCTL_SCGCGPIO_S3 | SYSCTL_SCGCGPIO_S4 | SYSCTL_SCGCGPIO_S5;
+    SYSCTL_SCGCUART_R = SYSCTL_SCGCUART_S0;
+    SYSCTL_SCGCPWM_R = SYSCTL_SCGCPWM_S0 | SYSCTL_SCGCPWM_S1;
+
+    lastWake = getTimeCycles();
+    windowWakes = 0;
+    busyCycles = 0;
+    sleepCycles = 0;
+}
+
+// Masks interrupts so the caller can check for work without racing an ISR
+void beginIdle(void)
+{
+    __asm("    cpsid i");
+}
+
+void endIdle(void)
+{
+    __asm("    cpsie i");
+}
+
+// Sleeps until the next interrupt, must be called between beginIdle() and endIdle()
+void sleepIdle(void)
+{
+    uint64_t start;
+    uint32_t count, slept, counted;
+
+    //uDMA and EEPROM only need a clock while they are busy
+    SYSCTL_SCGCDMA_R = isUart0TxIdle() ? 0 : SYSCTL_SCGCDMA_S0;
+    SYSCTL_SCGCEEPROM_R = isEepromBusy() ? SYSCTL_SCGCEEPROM_S0 : 0;
+
+    start = getTimeCycles();
+    count = latencyTimestamp();
+    busyCycles += start - lastWake;
+
+    __asm("    wfi");
+
+    lastWake = getTimeCycles();
+    slept = (uint32_t)(lastWake - start);
+    counted = latencyTimestamp() - count;
+    if (counted < slept)
+    {
+        adjustLatencyTimestamp(slept - counted);
+    }
+    sleepCycles += slept;
+    powerWakes++;
+    windowWakes++;
+}
+
+// Returns the busy time in 0.1% units since the previous call and starts a new window
+uint16_t getCpuLoad(uint32_t* wakes, uint32_t* windowMs)
+{
+    uint64_t now = getTimeCycles();
+    uint64_t busy = busyCycles + (now - lastWake);
+    uint64_t total = busy + sleepCycles;
+    uint16_t load = (total == 0) ? 0 : (uint16_t)((busy * 1000) / total);
+
+    *wakes = windowWakes;
+    *windowMs = (uint32_t)(total / CYCLES_PER_MS);
+
+    lastWake = now;
+    windowWakes = 0;
+    busyCycles = 0;
+    sleepCycles = 0;
+    return load;
+}
@@ -0,0 +1,29 @@
+// Low Power Idle
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern uint32_t powerWakes;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initPower(void);
+void beginIdle(void);
+void sleepIdle(void);
+void endIdle(void);
+uint16_t getCpuLoad(uint32_t* wakes, uint32_t* windowMs);
+
+#endif
@@ -0,0 +1,232 @@
+// Cooperative Task Scheduler
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Timer 2A is used as a one-shot wake timer for periodic tasks
+
+// Tasks run to completion in the order they were added, which is their
+// priority. A task is released when its period elapses, when its isReady()
+// check returns true, or both. Each pass runs every released task once, so a
+// task's latency is bounded by the sum of the execution times ahead of it.
+// When nothing is released the CPU sleeps (power.c) with Timer 2A armed for
+// the next periodic release, waking early every SCHED_MAX_WAKE_MS for longer
+// waits. setTaskPeriod() changes or disables (0) a period at runtime so a
+// task that is switched off costs no wakes. isReady() is evaluated with
+// interrupts masked before sleeping, so it must only read state and return
+// quickly. Releases and deadlines use the microsecond time base, execution
+// time is measured with the cycle counter. A deadline miss is counted when
+// completion is later than deadlineUs after the release: the due time for a
+// periodic release, the start of the pass for an event.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "sched.h"
+#include "power.h"
+#include "timebase.h"
+#include "perf.h"
+#include "clock.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static TASK tasks[MAX_TASKS];
+static uint8_t taskCount = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initScheduler(void)
+{
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R2;
+    while (!(SYSCTL_PRTIMER_R & SYSCTL_PRTIMER_R2));
+
+    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;                 // turn-off timer before reconfiguring
+    TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;           // configure as 32-bit timer (A+B)
+    TIMER2_TAMR_R = TIMER_TAMR_TAMR_1_SHOT;          // configure for one-shot mode (count down)
+    TIMER2_IMR_R = TIMER_IMR_TATOIM;                 // turn-on interrupts
+    NVIC_EN0_R = 1 << (INT_TIMER2A-16);              // turn-on interrupt 39 (TIMER2A)
+    taskCount = 0;
+}
+
+// Returns the task id, or TASK_INVALID if the table is full
+uint8_t addTask(const char* name, void (*run)(void), bool (*isReady)(void), uint32_t periodMs, uint32_t deadlineUs)
+{
+    TASK* task;
+
+    if (taskCount == MAX_TASKS)
+    {
+        return TASK_INVALID;
+    }
+
+    task = &tasks[taskCount];
+
+    task->name = name;
+    task->run = run;
+    task->isReady = isReady;
+    task->periodMs = periodMs;
+    task->deadlineUs = deadlineUs;
+    task->due = getTimeUs();
+    task->runs = 0;
+    task->misses = 0;
+    task->maxUs = 0;
+    task->totalCycles = 0;
+    setPerfName(PERF_STAGE + taskCount, name);
+    return taskCount++;
+}
+
+// Restarts the period with a release now, 0 stops periodic releases
+void setTaskPeriod(uint8_t id, uint32_t periodMs)
+{
+    if (id < taskCount)
+    {
+        tasks[id].periodMs = periodMs;
+        tasks[id].due = getTimeUs();
+    }
+}
+
+static bool isTaskDue(const TASK* task, uint64_t now)
+{
+    return task->periodMs != 0 && now >= task->due;
+}
+
+static void runTask(uint8_t id, uint64_t release)
+{
+    TASK* task = &tasks[id];
+    uint32_t start = PERF_CYCLES();
+    uint32_t cycles, us;
+
+    task->run();
+
+    cycles = PERF_CYCLES() - start;
+    if (perfEnabled)
+    {
+        recordPerf(PERF_STAGE + id, cycles);
+    }
+    us = cycles / CYCLES_PER_US;
+    task->runs++;
+    task->totalCycles += cycles;
+    if (us > task->maxUs)
+    {
+        task->maxUs = us;
+    }
+    if (getTimeUs() - release > task->deadlineUs)
+    {
+        task->misses++;
+    }
+}
+
+// Runs every released task once in priority order
+static void runTasks(void)
+{
+    uint64_t now;
+    uint64_t release;
+    uint32_t period;
+    uint8_t i;
+
+    for (i = 0; i < taskCount; i++)
+    {
+        TASK* task = &tasks[i];
+
+        now = getTimeUs();
+        if (isTaskDue(task, now))
+        {
+            release = task->due;
+            period = task->periodMs * 1000;
+            task->due += period;
+            if (now >= task->due)
+            {
+                task->due = now + period;            // overran a whole period, skip rather than burst
+            }
+        }
+        else if (task->isReady != 0 && task->isReady())
+        {
+            release = now;
+        }
+        else
+        {
+            continue;
+        }
+        runTask(i, release);
+    }
+}
+
+// Called with interrupts masked, arms the wake timer for the next periodic release
+static bool isTaskReleased(void)
+{
+    uint64_t now = getTimeUs();
+    uint64_t next = 0;
+    bool periodic = false;
+    uint8_t i;
+
+    for (i = 0; i < taskCount; i++)
+    {
+        const TASK* task = &tasks[i];
+
+        if (isTaskDue(task, now) || (task->isReady != 0 && task->isReady()))
+        {
+            return true;
+        }
+        if (task->periodMs != 0 && (!periodic || task->due < next))
+        {
+            next = task->due;
+            periodic = true;
+        }
+    }
+
+    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
+    if (periodic)
+    {
+        if (next - now > SCHED_MAX_WAKE_MS * 1000)
+        {
+            next = now + SCHED_MAX_WAKE_MS * 1000;   // wake early and re-arm
+        }
+        TIMER2_TAILR_R = (uint32_t)(next - now) * CYCLES_PER_US;
+        TIMER2_CTL_R |= TIMER_CTL_TAEN;
+    }
+    return false;
+}
+
+// Never returns, the main loop of the application
+void runScheduler(void)
+{
+    while (true)
+    {
+        runTasks();
+
+        beginIdle();
+        if (!isTaskReleased())
+        {
+            sleepIdle();
+        }
+        endIdle();
+    }
+}
+
+uint8_t getTaskCount(void)
+{
+    return taskCount;
+}
+
+const TASK* getTask(uint8_t id)
+{
+    return (id < taskCount) ? &tasks[id] : 0;
+}
+
+void schedTimerIsr(void)
+{
+    TIMER2_ICR_R = TIMER_ICR_TATOCINT;               // clear interrupt flag, waking the CPU is all it does
+}
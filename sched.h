@@ -0,0 +1,50 @@
+// Cooperative Task Scheduler
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Timer 2A is used as a one-shot wake timer for periodic tasks
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MAX_TASKS           8
+#define SCHED_MAX_WAKE_MS   10000   // keeps the 32-bit wake timer load in range at 80 MHz
+#define TASK_INVALID        0xFF
+
+typedef struct _TASK
+{
+    const char* name;
+    void (*run)(void);
+    bool (*isReady)(void);          // event trigger, NULL for a periodic-only task
+    uint32_t periodMs;              // 0 for an event-only or disabled periodic task
+    uint32_t deadlineUs;            // release to completion
+    uint64_t due;                   // time base (us) of the next periodic release
+    uint32_t runs;
+    uint32_t misses;
+    uint32_t maxUs;
+    uint64_t totalCycles;
+} TASK;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initScheduler(void);
+uint8_t addTask(const char* name, void (*run)(void), bool (*isReady)(void), uint32_t periodMs, uint32_t deadlineUs);
+void setTaskPeriod(uint8_t id, uint32_t periodMs);
+void runScheduler(void);
+uint8_t getTaskCount(void);
+const TASK* getTask(uint8_t id);
+void schedTimerIsr(void);
+
+#endif
@@ -0,0 +1,146 @@
+// Binary Telemetry Stream
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Records are built, CRC'd and COBS framed in place, then queued with the
+// non-blocking UART write. A record that does not fit in the TX buffers is
+// dropped and counted rather than stalling the caller. tools/telemetry_decode.c
+// converts the stream to CSV.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "telemetry.h"
+#include "timebase.h"
+#include "uart0.h"
+#include "crc.h"
+#include "cobs.h"
+
+#define MAX_TRACKED_EVENTS 20
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+bool telemetryEnabled = false;
+uint32_t telemetrySent = 0;
+uint32_t telemetryDropped = 0;
+
+static uint8_t sequence = 0;
+static uint8_t lastStatus[MAX_TRACKED_EVENTS];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void put16(uint8_t* p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v)
+{
+    put16(p, v);
+    put16(p + 2, v >> 16);
+}
+
+// Adds header and CRC to a record whose payload is already in place, then frames and queues it
+static void sendRecord(uint8_t* record, uint8_t type, uint8_t payloadLength)
+{
+    uint8_t frame[COBS_MAX(TLM_MAX_RECORD) + 2];
+    uint16_t length = TLM_HEADER_SIZE + payloadLength;
+    uint16_t frameLength;
+
+    record[0] = type;
+    record[1] = sequence++;
+    put32(&record[2], (uint32_t)getTimeUs());
+    put16(&record[length], crc16(CRC16_INIT, record, length));
+    length += 2;
+
+    // Leading delimiter separates the frame from any CLI text before it
+    frame[0] = 0;
+    frameLength = cobsEncode(record, length, &frame[1]) + 1;
+    frame[frameLength++] = 0;
+
+    if (getUart0TxFree() < frameLength)
+    {
+        telemetryDropped++;
+        return;
+    }
+    tryWriteUart0(frame, frameLength);
+    telemetrySent++;
+}
+
+void setTelemetry(bool on)
+{
+    uint8_t i;
+
+    for (i = 0; i < MAX_TRACKED_EVENTS; i++)
+    {
+        lastStatus[i] = 0;
+    }
+    telemetrySent = 0;
+    telemetryDropped = 0;
+    telemetryEnabled = on;
+}
+
+void sendSampleRecord(const uint32_t distance[3])
+{
+    uint8_t record[TLM_MAX_RECORD];
+    uint8_t i;
+
+    if (!telemetryEnabled)
+    {
+        return;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        put16(&record[TLM_HEADER_SIZE + 2*i], (distance[i] > 0xFFFF) ? 0xFFFF : distance[i]);
+    }
+    sendRecord(record, TLM_SAMPLE, 6);
+}
+
+// Sends a record for each event whose status changed since the last call
+void sendEventRecords(const uint8_t status[], uint8_t count)
+{
+    uint8_t record[TLM_MAX_RECORD];
+    uint8_t i;
+
+    if (!telemetryEnabled)
+    {
+        return;
+    }
+    for (i = 0; i < count && i < MAX_TRACKED_EVENTS; i++)
+    {
+        if (status[i] != lastStatus[i])
+        {
+            lastStatus[i] = status[i];
+            record[TLM_HEADER_SIZE] = i;
+            record[TLM_HEADER_SIZE + 1] = status[i];
+            sendRecord(record, TLM_EVENT, 2);
+        }
+    }
+}
+
+void sendHapticRecord(uint8_t event_n, uint8_t patternId)
+{
+    uint8_t record[TLM_MAX_RECORD];
+
+    if (!telemetryEnabled)
+    {
+        return;
+    }
+    record[TLM_HEADER_SIZE] = event_n;
+    record[TLM_HEADER_SIZE + 1] = patternId;
+    sendRecord(record, TLM_HAPTIC, 2);
+}
@@ -0,0 +1,41 @@
+// Binary Telemetry Stream
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Record types; every record is
+//   type, seq, timestamp (us, 32-bit LE), payload, CRC-16 (LE)
+// COBS encoded with a 0x00 delimiter on each side
+#define TLM_SAMPLE  1               // payload: distance 0-2 (mm, 16-bit LE each)
+#define TLM_EVENT   2               // payload: event, status
+#define TLM_HAPTIC  3               // payload: event, pattern ID
+
+#define TLM_HEADER_SIZE   6
+#define TLM_MAX_PAYLOAD   6
+#define TLM_MAX_RECORD    (TLM_HEADER_SIZE + TLM_MAX_PAYLOAD + 2)
+
+extern bool telemetryEnabled;
+extern uint32_t telemetrySent;
+extern uint32_t telemetryDropped;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void setTelemetry(bool on);
+void sendSampleRecord(const uint32_t distance[3]);
+void sendEventRecords(const uint8_t status[], uint8_t count);
+void sendHapticRecord(uint8_t event_n, uint8_t patternId);
+
+#endif
@@ -0,0 +1,75 @@
+// Monotonic Time Base
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Wide Timer 5 is used as a free-running 64-bit cycle counter
+
+// Wide Timer 5 runs as one 64-bit up counter at the system clock from boot.
+// It keeps its sleep mode clock (power.c), so unlike the DWT cycle counter
+// it never stops and does not wrap for thousands of years at 80 MHz. Time is
+// read as microseconds since initTimeBase(). Timeouts are absolute deadlines
+// checked with isDeadlinePassed(), so nothing has to busy-wait for them.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tm4c123gh6pm.h"
+#include "timebase.h"
+#include "clock.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initTimeBase(void)
+{
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R5;
+    while (!(SYSCTL_PRWTIMER_R & SYSCTL_PRWTIMER_R5));
+
+    WTIMER5_CTL_R &= ~TIMER_CTL_TAEN;                // turn-off timer before reconfiguring
+    WTIMER5_CFG_R = TIMER_CFG_32_BIT_TIMER;          // on a wide timer this is 64-bit (A+B)
+    WTIMER5_TAMR_R = TIMER_TAMR_TAMR_PERIOD | TIMER_TAMR_TACDIR;
+                                                     // configure for periodic mode, count up
+    WTIMER5_TAILR_R = 0xFFFFFFFF;                    // lower word of the 64-bit load value
+    WTIMER5_TBILR_R = 0xFFFFFFFF;                    // upper word of the 64-bit load value
+    WTIMER5_CTL_R |= TIMER_CTL_TAEN;                 // turn-on timer
+}
+
+// The upper word is read again to catch a carry between the two reads
+uint64_t getTimeCycles(void)
+{
+    uint32_t high, low;
+
+    do
+    {
+        high = WTIMER5_TBV_R;
+        low = WTIMER5_TAV_R;
+    } while (high != WTIMER5_TBV_R);
+    return ((uint64_t)high << 32) | low;
+}
+
+uint64_t getTimeUs(void)
+{
+    return getTimeCycles() / CYCLES_PER_US;
+}
+
+// Returns the time us microseconds from now
+uint64_t getDeadline(uint32_t us)
+{
+    return getTimeUs() + us;
+}
+
+bool isDeadlinePassed(uint64_t deadline)
+{
+    return getTimeUs() >= deadline;
+}
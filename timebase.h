@@ -0,0 +1,30 @@
+// Monotonic Time Base
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    see SYSTEM_CLOCK_MHZ in clock.h
+
+// Hardware configuration:
+// Wide Timer 5 is used as a free-running 64-bit cycle counter
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initTimeBase(void);
+uint64_t getTimeCycles(void);
+uint64_t getTimeUs(void);
+uint64_t getDeadline(uint32_t us);
+bool isDeadlinePassed(uint64_t deadline);
+
+#endif
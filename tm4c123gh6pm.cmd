@@ -10,7 +10,9 @@
 
 MEMORY
 {
-    FLASH (RX) : origin = 0x00000000, length = 0x00040000
+    FLASH (RX) : origin = 0x00000000, length = 0x00030000
+    /* Top 64 KB is the black box log (blackbox.h), nothing is linked there */
+    BLACKBOX (R) : origin = 0x00030000, length = 0x00010000
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
 
@@ -36,9 +38,9 @@ SECTIONS
     .init_array : > FLASH
 
     .vtable :   > 0x20000000
-    .data   :   > SRAM
-    .bss    :   > SRAM
-    .sysmem :   > SRAM
+    .data   :   > SRAM, RUN_START(__DATA_START), RUN_END(__DATA_END)
+    .bss    :   > SRAM, RUN_START(__BSS_START), RUN_END(__BSS_END)
+    .sysmem :   > SRAM, RUN_START(__SYSMEM_START), RUN_END(__SYSMEM_END)
     .stack  :   > SRAM
 }
 
@@ -0,0 +1,226 @@
+// Black Box Decoder (host tool)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+// Build:  gcc -I.. -o blackbox_decode blackbox_decode.c serial.c ../cobs.c ../crc.c
+// Usage:  blackbox_decode [-b BAUD] -d DEVICE > log.csv
+//         blackbox_decode dump.bin > log.csv
+
+// With -d the firmware is sent "blackbox dump" (after switching to BAUD if
+// given) and the dump is read until its end frame; otherwise the input is a
+// saved capture. Dump frames are reassembled into 1 KB pages and every
+// record is written as one CSV row with its absolute time. Pages come
+// oldest first; a page whose chunks are missing, fail the CRC or carry
+// different page sequences (a RAM page that moved to flash part way
+// through the dump) is reported on stderr and skipped.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+#include "cobs.h"
+#include "crc.h"
+#include "blackbox.h"
+
+#define MAX_FRAME (COBS_MAX(BB_DUMP_HEADER + BB_DUMP_CHUNK + 2) + 2)
+#define CHUNKS    (BLACKBOX_PAGE_SIZE / BB_DUMP_CHUNK)
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint8_t page[BLACKBOX_PAGE_SIZE];
+static uint8_t nextChunk = 0;
+static uint32_t pageSequence;
+static uint32_t pages = 0, records = 0, badPages = 0;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static uint32_t getU32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t getVarint(const uint8_t* p, uint16_t* index)
+{
+    uint32_t value = 0;
+    uint8_t shift = 0;
+
+    while (*index < BLACKBOX_PAGE_SIZE)
+    {
+        uint8_t b = p[(*index)++];
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+        {
+            break;
+        }
+        shift += 7;
+    }
+    return value;
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static void decodePage(void)
+{
+    uint32_t sequence = getU32(page);
+    uint16_t index = 4;
+    uint32_t time = 0;
+    int32_t distance[3] = { 0, 0, 0 };
+    uint8_t i;
+
+    pages++;
+    while (index < BLACKBOX_PAGE_SIZE && page[index] != BB_END)
+    {
+        uint8_t type = page[index++];
+
+        switch (type)
+        {
+        case BB_SYNC:
+            if (index + 10 > BLACKBOX_PAGE_SIZE) return;
+            time = page[index] | (page[index+1] << 8) | ((uint32_t)page[index+2] << 16) | ((uint32_t)page[index+3] << 24);
+            index += 4;
+            for (i = 0; i < 3; i++, index += 2)
+                distance[i] = page[index] | (page[index+1] << 8);
+            break;
+        case BB_SAMPLE:
+            time += getVarint(page, &index);
+            for (i = 0; i < 3; i++)
+                distance[i] += unzigzag(getVarint(page, &index));
+            printf("%u,%u,sample,%d,%d,%d\n", sequence, time, distance[0], distance[1], distance[2]);
+            records++;
+            break;
+        case BB_EVENT:
+            time += getVarint(page, &index);
+            if (index + 2 > BLACKBOX_PAGE_SIZE) return;
+            printf("%u,%u,event,%u,%u,\n", sequence, time, page[index], page[index+1]);
+            index += 2;
+            records++;
+            break;
+        default:
+            fprintf(stderr, "page %u: unknown record %u at %u\n", sequence, type, index - 1);
+            badPages++;
+            return;
+        }
+    }
+}
+
+// Returns true at the end frame
+static bool decodeFrame(const uint8_t* frame, uint16_t frameLength)
+{
+    uint8_t record[MAX_FRAME];
+    uint16_t length = cobsDecode(frame, frameLength, record);
+
+    if (length < 4 || record[0] != 'B'
+        || crc16(CRC16_INIT, record, length - 2) != (record[length-2] | (record[length-1] << 8)))
+    {
+        return false;                               // CLI text or telemetry
+    }
+    if (record[1] == BB_DUMP_END)
+    {
+        return true;
+    }
+    if (length != BB_DUMP_HEADER + BB_DUMP_CHUNK + 2 || record[1] != nextChunk)
+    {
+        fprintf(stderr, "chunk %u out of order, page dropped\n", record[1]);
+        badPages++;
+        nextChunk = 0;
+        return false;
+    }
+    if (record[1] == 0)
+    {
+        pageSequence = getU32(&record[2]);
+    }
+    else if (getU32(&record[2]) != pageSequence)
+    {
+        fprintf(stderr, "page %u: chunk %u is from page %u, page dropped\n", pageSequence, record[1], getU32(&record[2]));
+        badPages++;
+        nextChunk = 0;
+        return false;
+    }
+
+    memcpy(&page[record[1]*BB_DUMP_CHUNK], &record[BB_DUMP_HEADER], BB_DUMP_CHUNK);
+    if (++nextChunk == CHUNKS)
+    {
+        nextChunk = 0;
+        if (getU32(page) != pageSequence)
+        {
+            fprintf(stderr, "page %u: sequence does not match its chunks, page dropped\n", pageSequence);
+            badPages++;
+            return false;
+        }
+        decodePage();
+    }
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t baud = DEFAULT_BAUD;
+    uint8_t frame[MAX_FRAME];
+    uint16_t frameLength = 0;
+    bool overrun = false;
+    FILE* in = stdin;
+    int arg = 1;
+    int c;
+
+    if (arg + 1 < argc && strcmp(argv[arg], "-b") == 0)
+    {
+        baud = strtoul(argv[arg + 1], NULL, 10);
+        arg += 2;
+    }
+    if (arg + 1 < argc && strcmp(argv[arg], "-d") == 0)
+    {
+        int fd = openSerial(argv[arg + 1], DEFAULT_BAUD);
+
+        if (fd < 0 || (baud != DEFAULT_BAUD && !negotiateBaud(fd, DEFAULT_BAUD, baud)))
+        {
+            return 1;
+        }
+        writeSerial(fd, "\rblackbox dump\r", 15);
+        in = fdopen(fd, "rb");
+    }
+    else if (arg < argc && (in = fopen(argv[arg], "rb")) == NULL)
+    {
+        perror(argv[arg]);
+        return 1;
+    }
+
+    printf("page,time_ms,record,a,b,c\n");
+    while ((c = fgetc(in)) != EOF)
+    {
+        if (c != 0)
+        {
+            if (frameLength < MAX_FRAME)
+                frame[frameLength++] = c;
+            else
+                overrun = true;
+            continue;
+        }
+        if (frameLength != 0 && !overrun && decodeFrame(frame, frameLength))
+        {
+            break;
+        }
+        frameLength = 0;
+        overrun = false;
+    }
+
+    fprintf(stderr, "pages: %u  records: %u  bad pages: %u\n", pages, records, badPages);
+    return 0;
+}
@@ -0,0 +1,155 @@
+// EEPROM Access Benchmark (host tool)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+// Build:  gcc -O2 -DHOST_SIM -I.. -o eeprom_bench eeprom_bench.c
+// Usage:  eeprom_bench [iterations]
+
+// Builds ../eeprom.c against a simulated EEPROM register file and loads the
+// 184 word configuration image (12 blocks) word by word with readEeprom()
+// and block by block with readEepromBlock(). Reports peripheral register
+// accesses per load, which is what the target pays for (each one is a bus
+// access to the EEPROM module). Host time mostly measures the simulator
+// and is shown for reference only.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define IMAGE_WORDS 184
+
+// Simulated registers replace tm4c123gh6pm.h for eeprom.c
+#define __TM4C123GH6PM_H__
+#define SYSCTL_RCGCEEPROM_R     simRcgc
+#define SYSCTL_PREEPROM_R       simPr
+#define SYSCTL_PREEPROM_R0      0x00000001
+#define EEPROM_EEBLOCK_R        (*simAccess(&simBlock))
+#define EEPROM_EEOFFSET_R       (*simAccess(&simOffset))
+#define EEPROM_EERDWR_R         (*simWord(false))
+#define EEPROM_EERDWRINC_R      (*simWord(true))
+#define EEPROM_EEDONE_R         (*simAccess(&simDone))
+#define EEPROM_EEDONE_WORKING   0x00000001
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static uint32_t simRcgc;
+static uint32_t simPr = SYSCTL_PREEPROM_R0;       // module always ready
+static uint32_t simBlock, simOffset, simDone;
+static uint32_t simData[32][16];
+static uint32_t simAccesses;
+
+static uint32_t* simAccess(uint32_t* reg)
+{
+    simAccesses++;
+    return reg;
+}
+
+// The offset of EERDWRINC advances after the access and wraps within the block
+static uint32_t* simWord(bool increment)
+{
+    uint32_t* word = &simData[simBlock & 31][simOffset & 15];
+
+    simAccesses++;
+    if (increment)
+    {
+        simOffset = (simOffset + 1) & 15;
+    }
+    return word;
+}
+
+#include "../eeprom.c"
+
+static volatile uint32_t sink;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void loadWords(uint32_t image[])
+{
+    uint16_t add;
+
+    for (add = 0; add < IMAGE_WORDS; add++)
+    {
+        image[add] = readEeprom(add);
+    }
+}
+
+static void loadBlocks(uint32_t image[])
+{
+    uint16_t add;
+
+    for (add = 0; add < IMAGE_WORDS; add += 16)
+    {
+        readEepromBlock(add, &image[add], (IMAGE_WORDS - add < 16) ? IMAGE_WORDS - add : 16);
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Returns ns per load and sets accesses to register accesses per load
+static double run(void (*load)(uint32_t[]), uint32_t iterations, uint32_t* accesses)
+{
+    uint32_t image[IMAGE_WORDS];
+    double start;
+    uint32_t i;
+
+    simAccesses = 0;
+    load(image);
+    *accesses = simAccesses;
+
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+        load(image);
+        sink += image[i % IMAGE_WORDS];
+    }
+    return (now() - start) * 1e9 / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200000;
+    uint32_t a[IMAGE_WORDS], b[IMAGE_WORDS];
+    uint32_t wordAccesses, blockAccesses;
+    double wordNs, blockNs;
+    uint16_t i;
+
+    for (i = 0; i < 32*16; i++)
+    {
+        simData[i / 16][i % 16] = i * 2654435761u;
+    }
+    loadWords(a);
+    loadBlocks(b);
+    for (i = 0; i < IMAGE_WORDS; i++)
+    {
+        if (a[i] != b[i])
+        {
+            fprintf(stderr, "word %u differs\n", i);
+            return 1;
+        }
+    }
+
+    wordNs = run(loadWords, iterations, &wordAccesses);
+    blockNs = run(loadBlocks, iterations, &blockAccesses);
+    printf("readEeprom:      %5u register accesses  %8.1f ns/load\n", wordAccesses, wordNs);
+    printf("readEepromBlock: %5u register accesses  %8.1f ns/load\n", blockAccesses, blockNs);
+    return 0;
+}
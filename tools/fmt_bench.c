@@ -0,0 +1,120 @@
+// Formatter Benchmark (host tool)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+// Build:  gcc -O2 -I.. -o fmt_bench fmt_bench.c ../fmt.c
+// Usage:  fmt_bench [iterations]
+
+// Builds the "show events" and "display" lines with the snprintf formats
+// cli.c used before and with fmt.c, checks that both give the same text and
+// times them. Code size on the target is not measured here; compare the
+// .map files of a build with and without snprintf for that.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include "fmt.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static const uint32_t values[][3] =
+{
+    { 0, 100, 900 },
+    { 2, 1500, 3000 },
+    { 1, 0, 45 },
+    { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },         // erased event
+};
+
+#define VALUE_COUNT (sizeof(values)/sizeof(values[0]))
+
+static volatile uint32_t sink;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static void oldFormat(char* str, int32_t i, const uint32_t* v)
+{
+    char part[40];
+
+    str[0] = '\0';
+    snprintf(part, sizeof(part), "EVENT %2"PRId32"  ", i);
+    strcat(str, part);
+    snprintf(part, sizeof(part), "SENSOR %2"PRId32"  ", (int32_t)v[0]);
+    strcat(str, part);
+    snprintf(part, sizeof(part), "Min Distance: %4"PRIu32" mm  ", v[1]);
+    strcat(str, part);
+    snprintf(part, sizeof(part), "Max Distance: %4"PRIu32" mm\n", v[2]);
+    strcat(str, part);
+    snprintf(part, sizeof(part), "Sensor 0:    %5"PRIu32" (mm)\n", v[1]);
+    strcat(str, part);
+}
+
+static void newFormat(char* str, int32_t i, const uint32_t* v)
+{
+    char* p;
+
+    p = fmtI32(fmtStr(str, "EVENT "), i, 2);
+    p = fmtI32(fmtStr(p, "  SENSOR "), v[0], 2);
+    p = fmtU32(fmtStr(p, "  Min Distance: "), v[1], 4);
+    p = fmtU32(fmtStr(p, " mm  Max Distance: "), v[2], 4);
+    p = fmtStr(p, " mm\n");
+    fmtStr(fmtU32(fmtStr(p, "Sensor 0:    "), v[1], 5), " (mm)\n");
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Returns ns per line
+static double run(void (*format)(char*, int32_t, const uint32_t*), uint32_t iterations)
+{
+    char str[160];
+    double start = now();
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++)
+    {
+        format(str, i & 15, values[i % VALUE_COUNT]);
+        sink += str[7];
+    }
+    return (now() - start) * 1e9 / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 2000000;
+    char a[160], b[160];
+    uint32_t i;
+
+    for (i = 0; i < 16 * VALUE_COUNT; i++)
+    {
+        oldFormat(a, i & 15, values[i % VALUE_COUNT]);
+        newFormat(b, i & 15, values[i % VALUE_COUNT]);
+        if (strcmp(a, b) != 0)
+        {
+            fprintf(stderr, "output differs:\n%s%s", a, b);
+            return 1;
+        }
+    }
+
+    printf("snprintf: %7.1f ns/line\n", run(oldFormat, iterations));
+    printf("fmt:      %7.1f ns/line\n", run(newFormat, iterations));
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Command Parse and Dispatch Benchmark (host tool)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+// Build:  gcc -O2 -I.. -o parse_bench parse_bench.c ../parse.c ../command.c
+// Usage:  parse_bench [iterations]
+
+// Times parseFields plus command lookup for a mix of CLI lines, comparing
+// the old chain of isCommand() calls (each copying field 0 with strncat and
+// then strcmp) against dispatchCommand() on a sorted table. The table here
+// mirrors the names and argument rules of the firmware's table in cli.c
+// with empty handlers.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "parse.h"
+#include "command.h"
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+static volatile uint32_t handled;
+
+static void cmdAny(USER_DATA* data)
+{
+    (void)data;
+    handled++;
+}
+
+static const COMMAND benchTable[] =
+{
+    { "and",       3, "nnn",   cmdAny, "" },
+    { "baud",      0, "n",     cmdAny, "" },
+    { "display",   0, "",      cmdAny, "" },
+    { "erase",     1, "n",     cmdAny, "" },
+    { "event",     4, "nnnn",  cmdAny, "" },
+    { "haptic",    2, "na",    cmdAny, "" },
+    { "help",      0, "",      cmdAny, "" },
+    { "latency",   0, "a",     cmdAny, "" },
+    { "pattern",   5, "nnnnn", cmdAny, "" },
+    { "reboot",    0, "",      cmdAny, "" },
+    { "show",      1, "a",     cmdAny, "" },
+    { "telemetry", 0, "a",     cmdAny, "" },
+    { "use",       2, "nn",    cmdAny, "" },
+};
+
+#define BENCH_COUNT (sizeof(benchTable)/sizeof(COMMAND))
+
+static const char* lines[] =
+{
+    "event 3 1 100 900",
+    "pattern 12 80 3 200 100",
+    "show events",
+    "haptic 4 on",
+    "and 17 2 5",
+    "use 6 4",
+    "telemetry on",
+    "baud 921600",
+};
+
+#define LINE_COUNT (sizeof(lines)/sizeof(lines[0]))
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+// The original per-command test: copy field 0 a character at a time, then compare
+static bool oldIsCommand(USER_DATA* data, const char strCommand[], uint8_t minArguments)
+{
+    char field[MAX_CHARS+1] = "";
+    int index = data->fieldPosition[0];
+
+    while (data->buffer[index] != '\0')
+    {
+        char c = data->buffer[index++];
+        strncat(field, &c, 1);
+    }
+    return !strcmp(field, strCommand) && data->fieldCount > minArguments;
+}
+
+static void oldDispatch(USER_DATA* data)
+{
+    if (oldIsCommand(data, "help", 0))      cmdAny(data);
+    if (oldIsCommand(data, "reboot", 0))    cmdAny(data);
+    if (oldIsCommand(data, "event", 4))     cmdAny(data);
+    if (oldIsCommand(data, "and", 3))       cmdAny(data);
+    if (oldIsCommand(data, "erase", 1))     cmdAny(data);
+    if (oldIsCommand(data, "show", 1))      cmdAny(data);
+    if (oldIsCommand(data, "haptic", 2))    cmdAny(data);
+    if (oldIsCommand(data, "pattern", 5))   cmdAny(data);
+    if (oldIsCommand(data, "use", 2))       cmdAny(data);
+    if (oldIsCommand(data, "latency", 0))   cmdAny(data);
+    if (oldIsCommand(data, "telemetry", 0)) cmdAny(data);
+    if (oldIsCommand(data, "baud", 0))      cmdAny(data);
+    if (oldIsCommand(data, "display", 0))   cmdAny(data);
+}
+
+static void newDispatch(USER_DATA* data)
+{
+    dispatchCommand(benchTable, BENCH_COUNT, data);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Returns ns per line for parse + dispatch
+static double run(void (*dispatch)(USER_DATA*), uint32_t iterations)
+{
+    USER_DATA data;
+    double start = now();
+    uint32_t i;
+
+    for (i = 0; i < iterations; i++)
+    {
+        strcpy(data.buffer, lines[i % LINE_COUNT]);
+        parseFields(&data);
+        dispatch(&data);
+    }
+    return (now() - start) * 1e9 / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 2000000;
+    double oldNs, newNs;
+
+    handled = 0;
+    oldNs = run(oldDispatch, iterations);
+    if (handled != iterations)
+    {
+        fprintf(stderr, "old dispatch handled %u of %u lines\n", handled, iterations);
+    }
+
+    handled = 0;
+    newNs = run(newDispatch, iterations);
+    if (handled != iterations)
+    {
+        fprintf(stderr, "table dispatch handled %u of %u lines\n", handled, iterations);
+    }
+
+    printf("isCommand chain: %7.1f ns/line\n", oldNs);
+    printf("table dispatch:  %7.1f ns/line\n", newNs);
+    return 0;
+}
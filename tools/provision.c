@@ -0,0 +1,155 @@
+// Configuration Provisioning (host tool)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+// Build:  gcc -I.. -o provision provision.c serial.c ../cobs.c ../crc.c
+// Usage:  provision [-b BAUD] DEVICE PROFILE       write PROFILE to the cane
+//         provision -e [-b BAUD] DEVICE PROFILE    save the cane's configuration
+
+// A profile is the binary blob from the firmware's "export" command (see
+// config.h), so a profile is made by configuring one cane with the CLI and
+// exporting it. The blob is sent as a single COBS frame after "import"; the
+// firmware checks the CRC, validates every event and commits the whole
+// configuration in one transaction, or changes nothing.
+// At 115200 baud the 728 byte blob takes about 65 ms on the wire.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+#include "cobs.h"
+#include "crc.h"
+#include "config.h"
+
+#define MAX_FRAME (COBS_MAX(CONFIG_BLOB_SIZE) + 2)
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static bool isValidBlob(const uint8_t* blob, uint32_t length)
+{
+    return length == CONFIG_BLOB_SIZE && blob[0] == 'H' && blob[1] == 'C'
+        && blob[2] == CONFIG_BLOB_VERSION
+        && crc16(CRC16_INIT, blob, length - 2) == (blob[length-2] | (blob[length-1] << 8));
+}
+
+static int exportProfile(int fd, const char* path)
+{
+    uint8_t frame[MAX_FRAME];
+    uint8_t blob[MAX_FRAME];
+    uint32_t frameLength;
+    FILE* out;
+
+    writeSerial(fd, "\rexport\r", 8);
+
+    // Telemetry records may share the stream, keep the frame that is a blob
+    while (readSerialFrame(fd, frame, sizeof(frame), &frameLength, 1000))
+    {
+        uint16_t length = cobsDecode(frame, frameLength, blob);
+
+        if (!isValidBlob(blob, length))
+        {
+            continue;
+        }
+        if ((out = fopen(path, "wb")) == NULL || fwrite(blob, 1, length, out) != length)
+        {
+            perror(path);
+            return 1;
+        }
+        fclose(out);
+        fprintf(stderr, "saved %u bytes to %s\n", length, path);
+        return 0;
+    }
+
+    fprintf(stderr, "no configuration received\n");
+    return 1;
+}
+
+static int importProfile(int fd, const char* path)
+{
+    uint8_t blob[CONFIG_BLOB_SIZE + 1];
+    uint8_t frame[MAX_FRAME];
+    uint32_t length, frameLength;
+    char line[80];
+    FILE* in;
+
+    if ((in = fopen(path, "rb")) == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    length = fread(blob, 1, sizeof(blob), in);
+    fclose(in);
+    if (!isValidBlob(blob, length))
+    {
+        fprintf(stderr, "%s: not a configuration profile\n", path);
+        return 1;
+    }
+
+    writeSerial(fd, "\rimport\r", 8);
+    if (!waitSerialReply(fd, "IMPORT READY", line, sizeof(line), 1000))
+    {
+        fprintf(stderr, "firmware did not accept import\n");
+        return 1;
+    }
+
+    frame[0] = 0;
+    frameLength = cobsEncode(blob, length, &frame[1]) + 1;
+    frame[frameLength++] = 0;
+    writeSerial(fd, frame, frameLength);
+
+    if (!waitSerialReply(fd, "IMPORT", line, sizeof(line), 3000))
+    {
+        fprintf(stderr, "no reply to import\n");
+        return 1;
+    }
+    fprintf(stderr, "%s\n", line);
+    return strncmp(line, "IMPORT OK", 9) == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t baud = DEFAULT_BAUD;
+    bool export = false;
+    int arg = 1;
+    int fd;
+
+    if (arg < argc && strcmp(argv[arg], "-e") == 0)
+    {
+        export = true;
+        arg++;
+    }
+    if (arg + 1 < argc && strcmp(argv[arg], "-b") == 0)
+    {
+        baud = strtoul(argv[arg + 1], NULL, 10);
+        arg += 2;
+    }
+    if (arg + 2 != argc)
+    {
+        fprintf(stderr, "usage: provision [-e] [-b BAUD] DEVICE PROFILE\n");
+        return 1;
+    }
+
+    if ((fd = openSerial(argv[arg], DEFAULT_BAUD)) < 0)
+    {
+        return 1;
+    }
+    if (baud != DEFAULT_BAUD && !negotiateBaud(fd, DEFAULT_BAUD, baud))
+    {
+        return 1;
+    }
+
+    return export ? exportProfile(fd, argv[arg + 1]) : importProfile(fd, argv[arg + 1]);
+}
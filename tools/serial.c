@@ -0,0 +1,208 @@
+// Serial Port Helpers (host tools)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+
+// Raw termios access to the virtual COM port and the host half of the
+// "baud" negotiation: request the rate at the current speed, wait for
+// "BAUD <rate> OK", switch the port and confirm with "ack". If the firmware
+// does not hear the ack within 2 s it returns to the previous rate, so the
+// host does the same when no "BAUD CONFIRMED" comes back.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include "serial.h"
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static speed_t toSpeed(uint32_t baud)
+{
+    switch (baud)
+    {
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 921600:  return B921600;
+    case 1000000: return B1000000;
+    case 1500000: return B1500000;
+    case 2000000: return B2000000;
+    case 2500000: return B2500000;
+    case 3000000: return B3000000;
+    case 4000000: return B4000000;
+#ifdef B5000000
+    case 5000000: return B5000000;
+#endif
+    default:      return 0;
+    }
+}
+
+bool setSerialBaud(int fd, uint32_t baud)
+{
+    struct termios tty;
+    speed_t speed = toSpeed(baud);
+
+    if (speed == 0 || tcgetattr(fd, &tty) != 0)
+    {
+        return false;
+    }
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cflag |= CLOCAL | CREAD;
+    return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+// Opens a port in raw 8N1 mode, returns -1 on failure
+int openSerial(const char* path, uint32_t baud)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY);
+
+    if (fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+    if (!setSerialBaud(fd, baud))
+    {
+        fprintf(stderr, "%s: cannot set %u baud\n", path, baud);
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+bool writeSerial(int fd, const void* data, uint32_t length)
+{
+    const uint8_t* p = data;
+
+    while (length != 0)
+    {
+        ssize_t n = write(fd, p, length);
+        if (n <= 0)
+        {
+            return false;
+        }
+        p += n;
+        length -= n;
+    }
+    return tcdrain(fd) == 0;
+}
+
+// Reads one '\n' terminated line (without the terminator)
+bool readSerialLine(int fd, char* line, uint32_t size, uint32_t timeoutMs)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    uint32_t count = 0;
+    char c;
+
+    while (poll(&pfd, 1, timeoutMs) > 0 && read(fd, &c, 1) == 1)
+    {
+        if (c == '\n')
+        {
+            line[count] = '\0';
+            return true;
+        }
+        if (c != '\r' && count < size - 1)
+        {
+            line[count++] = c;
+        }
+    }
+    line[count] = '\0';
+    return false;
+}
+
+// Reads the next non-empty 0x00 delimited frame (without delimiters);
+// frames longer than size are skipped
+bool readSerialFrame(int fd, uint8_t* frame, uint32_t size, uint32_t* length, uint32_t timeoutMs)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    uint32_t count = 0;
+    bool synced = false;
+    bool overrun = false;
+    uint8_t c;
+
+    while (poll(&pfd, 1, timeoutMs) > 0 && read(fd, &c, 1) == 1)
+    {
+        if (c != 0)
+        {
+            if (count < size)
+                frame[count++] = c;
+            else
+                overrun = true;
+            continue;
+        }
+        if (synced && count != 0 && !overrun)
+        {
+            *length = count;
+            return true;
+        }
+        synced = true;
+        count = 0;
+        overrun = false;
+    }
+    return false;
+}
+
+// Skips lines until one starts with prefix
+bool waitSerialReply(int fd, const char* prefix, char* line, uint32_t size, uint32_t timeoutMs)
+{
+    while (readSerialLine(fd, line, size, timeoutMs))
+    {
+        if (strncmp(line, prefix, strlen(prefix)) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns false with the port back at fromBaud if the switch did not complete
+bool negotiateBaud(int fd, uint32_t fromBaud, uint32_t baud)
+{
+    char line[80];
+
+    if (toSpeed(baud) == 0)
+    {
+        fprintf(stderr, "unsupported host baud rate %u\n", baud);
+        return false;
+    }
+
+    snprintf(line, sizeof(line), "\rbaud %u\r", baud);
+    writeSerial(fd, line, strlen(line));
+    if (!waitSerialReply(fd, "BAUD", line, sizeof(line), 1000) || strstr(line, "OK") == NULL)
+    {
+        fprintf(stderr, "firmware refused %u baud: %s\n", baud, line);
+        return false;
+    }
+
+    setSerialBaud(fd, baud);
+    usleep(20000);
+    tcflush(fd, TCIFLUSH);
+    writeSerial(fd, "ack\r", 4);
+    if (!waitSerialReply(fd, "BAUD CONFIRMED", line, sizeof(line), 1500))
+    {
+        fprintf(stderr, "no confirmation at %u baud, returning to %u\n", baud, fromBaud);
+        usleep(1000000);                                // let the firmware's 2 s window close
+        setSerialBaud(fd, fromBaud);
+        tcflush(fd, TCIOFLUSH);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+// Serial Port Helpers (host tools)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+
+#ifndef SERIAL_H_
+#define SERIAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DEFAULT_BAUD 115200
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+int openSerial(const char* path, uint32_t baud);
+bool setSerialBaud(int fd, uint32_t baud);
+bool writeSerial(int fd, const void* data, uint32_t length);
+bool readSerialLine(int fd, char* line, uint32_t size, uint32_t timeoutMs);
+bool readSerialFrame(int fd, uint8_t* frame, uint32_t size, uint32_t* length, uint32_t timeoutMs);
+bool waitSerialReply(int fd, const char* prefix, char* line, uint32_t size, uint32_t timeoutMs);
+bool negotiateBaud(int fd, uint32_t fromBaud, uint32_t toBaud);
+
+#endif
@@ -0,0 +1,160 @@
+// Telemetry Stream Decoder (host tool)
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Target
+//-----------------------------------------------------------------------------
+
+// Linux host
+// Build:  gcc -I.. -o telemetry_decode telemetry_decode.c serial.c ../cobs.c ../crc.c
+// Usage:  telemetry_decode -b 921600 /dev/ttyACM0 > log.csv
+//         telemetry_decode < capture.bin > log.csv
+
+// With -b the port is opened at 115200, switched to BAUD with the firmware's
+// "baud" negotiation and telemetry is turned on; without it the input is a
+// file or stdin.
+
+// Splits the stream on 0x00, COBS decodes and CRC checks each frame and
+// writes one CSV row per record. Text from CLI replies fails the CRC check
+// and is skipped. Counts of good, bad and missing records go to stderr.
+
+//-----------------------------------------------------------------------------
+// Includes and defines
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+#include "cobs.h"
+#include "crc.h"
+#include "telemetry.h"
+
+#define MAX_FRAME 256
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static uint16_t get16(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* p)
+{
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+// Returns the record's sequence number, or -1 if the frame is not a valid
+// record
+static int decodeRecord(const uint8_t* frame, uint16_t frameLength)
+{
+    uint8_t record[MAX_FRAME];
+    uint16_t length = cobsDecode(frame, frameLength, record);
+    const uint8_t* payload = &record[TLM_HEADER_SIZE];
+    uint32_t time;
+
+    if (length < TLM_HEADER_SIZE + 2)
+    {
+        return -1;
+    }
+    length -= 2;
+    if (crc16(CRC16_INIT, record, length) != get16(&record[length]))
+    {
+        return -1;
+    }
+
+    time = get32(&record[2]);
+    switch (record[0])
+    {
+    case TLM_SAMPLE:
+        if (length != TLM_HEADER_SIZE + 6) return -1;
+        printf("sample,%u,%u,%u,%u,%u\n", record[1], time, get16(payload), get16(payload + 2), get16(payload + 4));
+        break;
+    case TLM_EVENT:
+        if (length != TLM_HEADER_SIZE + 2) return -1;
+        printf("event,%u,%u,%u,%u,\n", record[1], time, payload[0], payload[1]);
+        break;
+    case TLM_HAPTIC:
+        if (length != TLM_HEADER_SIZE + 2) return -1;
+        printf("haptic,%u,%u,%u,%u,\n", record[1], time, payload[0], payload[1]);
+        break;
+    default:
+        return -1;
+    }
+    return record[1];
+}
+
+int main(int argc, char* argv[])
+{
+    FILE* in = stdin;
+    uint8_t frame[MAX_FRAME];
+    uint16_t frameLength = 0;
+    bool overrun = false;
+    uint32_t good = 0, bad = 0, missing = 0;
+    int lastSeq = -1;
+    int c;
+
+    if (argc > 2 && strcmp(argv[1], "-b") == 0)
+    {
+        uint32_t baud = strtoul(argv[2], NULL, 10);
+        int fd;
+
+        if (argc < 4 || (fd = openSerial(argv[3], DEFAULT_BAUD)) < 0)
+        {
+            fprintf(stderr, "usage: telemetry_decode [-b BAUD DEVICE | FILE]\n");
+            return 1;
+        }
+        if (baud != DEFAULT_BAUD && !negotiateBaud(fd, DEFAULT_BAUD, baud))
+        {
+            return 1;
+        }
+        writeSerial(fd, "telemetry on\r", 13);
+        in = fdopen(fd, "rb");
+    }
+    else if (argc > 1 && (in = fopen(argv[1], "rb")) == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    printf("record,seq,time_us,a,b,c\n");
+    while ((c = fgetc(in)) != EOF)
+    {
+        if (c != 0)
+        {
+            if (frameLength < MAX_FRAME)
+                frame[frameLength++] = c;
+            else
+                overrun = true;
+            continue;
+        }
+
+        if (frameLength != 0)
+        {
+            int seq = overrun ? -1 : decodeRecord(frame, frameLength);
+
+            if (seq >= 0)
+            {
+                if (lastSeq >= 0)
+                    missing += (uint8_t)(seq - lastSeq - 1);
+                lastSeq = seq;
+                good++;
+            }
+            else
+            {
+                bad++;
+            }
+            fflush(stdout);
+        }
+        frameLength = 0;
+        overrun = false;
+    }
+
+    fprintf(stderr, "records: %u  bad frames: %u  missing: %u\n", good, bad, missing);
+    return 0;
+}
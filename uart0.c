@@ -15,6 +15,12 @@
 //   The USB on the 2nd controller enumerates to an ICDI interface and a virtual COM port
 //   Configured to 115,200 baud, 8N1
 
+// Receive is interrupt driven through a ring buffer. Transmit is fed by
+// uDMA channel 9 from two output buffers: the CPU formats into one while the
+// other is being sent, so output costs no per-byte interrupts. The put
+// functions only block when both buffers are full; the try variants never
+// block and report how much was accepted.
+
 //-----------------------------------------------------------------------------
 // Device includes, defines, and assembler directives
 //-----------------------------------------------------------------------------
@@ -23,18 +29,46 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "tm4c123gh6pm.h"
 #include "uart0.h"
+#include "clock.h"
+#include "timebase.h"
+#include "perf.h"
 
 // PortA masks
 #define UART_TX_MASK 2
 #define UART_RX_MASK 1
 
+// Boot baud rate divisor x64, rounded, from r = fcyc / (16 x baud)
+#define UART0_BOOT_BAUD 115200
+#define UART0_BOOT_DIV64 ((SYSTEM_CLOCK_HZ * 8 / UART0_BOOT_BAUD + 1) / 2)
+
+// Buffer sizes (RX is a power of 2, TX is limited to one uDMA transfer)
+#define TX_BUFFER_SIZE 1024
+#define RX_BUFFER_SIZE 128
+
+// uDMA channel 9, encoding 0 is UART0 TX
+#define UART0_TX_DMA_CH 9
 
 //-----------------------------------------------------------------------------
 // Global variables
 //-----------------------------------------------------------------------------
 
+// uDMA channel control table (primary entries only), must be 1024-byte aligned
+#pragma DATA_ALIGN(dmaTable, 1024)
+static volatile uint32_t dmaTable[128];
+
+static char txBuffer[2][TX_BUFFER_SIZE];
+static volatile uint16_t txCount[2] = {0, 0};
+static volatile uint8_t fillIndex = 0;              // buffer the CPU is writing
+static volatile bool dmaBusy = false;
+static char rxBuffer[RX_BUFFER_SIZE];
+static volatile uint16_t rxHead = 0, rxTail = 0;
+static volatile uint32_t rxLastUs = 0;              // low word of the time base at the last RX interrupt
+uint32_t uart0RxOverflows = 0;
+uint32_t uart0BaudRate = 115200;
+
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
@@ -45,7 +79,16 @@ void initUart0()
     // Enable clocks
     SYSCTL_RCGCUART_R |= SYSCTL_RCGCUART_R0;
     SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R0;
-    _delay_cycles(3);
+    SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0;
+    while (!(SYSCTL_PRUART_R & SYSCTL_PRUART_R0) || !(SYSCTL_PRGPIO_R & SYSCTL_PRGPIO_R0) || !(SYSCTL_PRDMA_R & SYSCTL_PRDMA_R0));
+
+    // Configure uDMA for UART0 TX
+    UDMA_CFG_R = UDMA_CFG_MASTEN;                       // enable uDMA controller
+    UDMA_CTLBASE_R = (uint32_t)dmaTable;                // set channel control table
+    UDMA_CHMAP1_R &= ~(0xF << ((UART0_TX_DMA_CH-8)*4)); // map channel 9 to UART0 TX
+    UDMA_USEBURSTCLR_R = 1 << UART0_TX_DMA_CH;          // allow single and burst requests
+    UDMA_ALTCLR_R = 1 << UART0_TX_DMA_CH;               // use primary control entry
+    UDMA_REQMASKCLR_R = 1 << UART0_TX_DMA_CH;           // allow peripheral requests
 
     // Configure UART0 pins
     GPIO_PORTA_DR2R_R |= UART_TX_MASK;                  // set drive strength to 2mA (not needed since default configuration -- for clarity)
@@ -57,171 +100,301 @@ void initUart0()
 
     // Configure UART0 to 115200 baud, 8N1 format
     UART0_CTL_R = 0;                                    // turn-off UART0 to allow safe programming
-    UART0_CC_R = UART_CC_CS_SYSCLK;                     // use system clock (40 MHz)
-    UART0_IBRD_R = 21;                                  // r = 40 MHz / (Nx115.2kHz), set floor(r)=21, where N=16
-    UART0_FBRD_R = 45;                                  // round(fract(r)*64)=45
+    UART0_CC_R = UART_CC_CS_SYSCLK;                     // use system clock (SYSTEM_CLOCK_MHZ)
+    UART0_IBRD_R = UART0_BOOT_DIV64 / 64;               // floor(r), 21 at 40 MHz
+    UART0_FBRD_R = UART0_BOOT_DIV64 % 64;               // round(fract(r)*64), 45 at 40 MHz
     UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;    // configure for 8N1 w/ 16-level FIFO
+    UART0_IFLS_R = UART_IFLS_RX4_8 | UART_IFLS_TX1_8;   // interrupt at RX half full, TX 1/8 full
+    UART0_IM_R = UART_IM_RXIM | UART_IM_RTIM;          // turn-on RX and RX time-out interrupts
+    UART0_DMACTL_R = UART_DMACTL_TXDMAE;                // TX FIFO is fed by uDMA
     UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN;
                                                         // enable TX, RX, and module
+    NVIC_EN0_R = 1 << (INT_UART0-16);                   // turn-on interrupt 21 (UART0)
 }
 
-// Set baud rate as function of instruction cycle frequency
-void setUart0BaudRate(uint32_t baudRate, uint32_t fcyc)
+// Calculates the divisor for a baud rate and returns the resulting rate error in ppm
+// Rates above fcyc/16 use high-speed mode (8x oversampling), up to fcyc/8
+int32_t getUart0BaudDivisor(uint32_t baudRate, uint32_t fcyc, uint32_t* divisorTimes64, bool* highSpeed)
 {
-    uint32_t divisorTimes128 = (fcyc * 8) / baudRate;   // calculate divisor (r) in units of 1/128,
-                                                        // where r = fcyc / 16 * baudRate
+    uint32_t clkDiv;
+    uint32_t divisorTimes128;
+    uint32_t actual;
+
+    *highSpeed = (baudRate > fcyc / 16);
+    clkDiv = *highSpeed ? 8 : 16;
+    if (baudRate == 0 || baudRate > fcyc / 8)
+    {
+        *divisorTimes64 = 0;
+        return INT32_MAX;
+    }
+
+    divisorTimes128 = (uint32_t)(((uint64_t)fcyc * 128) / ((uint64_t)clkDiv * baudRate));
+                                                        // calculate divisor (r) in units of 1/128,
+                                                        // where r = fcyc / (clkDiv * baudRate)
     divisorTimes128 += 1;                               // add 1/128 to allow rounding
+    *divisorTimes64 = divisorTimes128 >> 1;             // round(r*64)
+    if (*divisorTimes64 < 64 || *divisorTimes64 > (0xFFFF << 6))
+    {
+        return INT32_MAX;                               // integer part must be 1-65535
+    }
+
+    actual = (uint32_t)(((uint64_t)fcyc * 64) / ((uint64_t)clkDiv * *divisorTimes64));
+    return (int32_t)(((int64_t)actual - baudRate) * 1000000 / baudRate);
+}
+
+// Set baud rate as function of instruction cycle frequency
+// Returns false and leaves the UART unchanged if the rate error would exceed UART_MAX_BAUD_ERROR_PPM
+bool setUart0BaudRate(uint32_t baudRate, uint32_t fcyc)
+{
+    uint32_t divisorTimes64;
+    bool highSpeed;
+    int32_t error = getUart0BaudDivisor(baudRate, fcyc, &divisorTimes64, &highSpeed);
+
+    if (error > UART_MAX_BAUD_ERROR_PPM || error < -UART_MAX_BAUD_ERROR_PPM)
+    {
+        return false;
+    }
+
     UART0_CTL_R = 0;                                    // turn-off UART0 to allow safe programming
-    UART0_IBRD_R = divisorTimes128 >> 7;                // set integer value to floor(r)
-    UART0_FBRD_R = ((divisorTimes128) >> 1) & 63;       // set fractional value to round(fract(r)*64)
+    UART0_IBRD_R = divisorTimes64 >> 6;                 // set integer value to floor(r)
+    UART0_FBRD_R = divisorTimes64 & 63;                 // set fractional value to round(fract(r)*64)
     UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN;    // configure for 8N1 w/ 16-level FIFO
-    UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN;
+    UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN | (highSpeed ? UART_CTL_HSE : 0);
                                                         // turn-on UART0
+    uart0BaudRate = baudRate;
+    return true;
+}
+
+// Hands the fill buffer to uDMA if the channel is idle and swaps buffers
+// Called from the UART0 ISR or with the UART0 interrupt disabled
+static void startTxDma()
+{
+    uint16_t count = txCount[fillIndex];
+    volatile uint32_t* entry = &dmaTable[UART0_TX_DMA_CH*4];
+
+    if (dmaBusy || count == 0)
+    {
+        return;
+    }
+
+    entry[0] = (uint32_t)&txBuffer[fillIndex][count-1]; // source end pointer
+    entry[1] = (uint32_t)&UART0_DR_R;                   // destination end pointer
+    entry[2] = UDMA_CHCTL_DSTINC_NONE | UDMA_CHCTL_DSTSIZE_8 | UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_SRCSIZE_8
+             | UDMA_CHCTL_ARBSIZE_4 | ((count-1) << UDMA_CHCTL_XFERSIZE_S) | UDMA_CHCTL_XFERMODE_BASIC;
+    dmaBusy = true;
+    fillIndex ^= 1;
+    txCount[fillIndex] = 0;
+    UDMA_ENASET_R = 1 << UART0_TX_DMA_CH;               // start transfer
+}
+
+// Returns the number of characters that can be queued without blocking
+uint16_t getUart0TxFree()
+{
+    return TX_BUFFER_SIZE - txCount[fillIndex];
+}
+
+// Returns true when nothing is queued or being moved by uDMA
+bool isUart0TxIdle()
+{
+    return !dmaBusy && txCount[fillIndex] == 0;
+}
+
+// Blocks until all queued output has left the transmitter
+void flushUart0()
+{
+    while (dmaBusy || txCount[fillIndex] != 0 || (UART0_FR_R & UART_FR_BUSY))
+    {
+        if (!dmaBusy)
+        {
+            NVIC_DIS0_R = 1 << (INT_UART0-16);
+            startTxDma();
+            NVIC_EN0_R = 1 << (INT_UART0-16);
+        }
+    }
+}
+
+// Non-blocking function that queues as many bytes as fit, returns the count queued
+static uint16_t queueTx(const char* str, uint16_t length)
+{
+    uint16_t count = 0;
+
+    NVIC_DIS0_R = 1 << (INT_UART0-16);
+    while (count < length)
+    {
+        uint16_t n = txCount[fillIndex];
+        if (n == TX_BUFFER_SIZE)
+        {
+            startTxDma();
+            if (txCount[fillIndex] == TX_BUFFER_SIZE)
+            {
+                break;
+            }
+            n = 0;
+        }
+        txBuffer[fillIndex][n] = str[count++];
+        txCount[fillIndex] = n + 1;
+    }
+    startTxDma();
+    NVIC_EN0_R = 1 << (INT_UART0-16);
+    return count;
+}
+
+// Non-blocking function that queues a character, returns false if both buffers are full
+bool tryPutcUart0(char c)
+{
+    return queueTx(&c, 1) == 1;
+}
+
+// Non-blocking function that queues as much of a string as fits, returns the count queued
+uint16_t tryPutsUart0(const char* str)
+{
+    return queueTx(str, strlen(str));
+}
+
+// Non-blocking function that queues binary data, returns the count queued
+uint16_t tryWriteUart0(const uint8_t* data, uint16_t length)
+{
+    return queueTx((const char*)data, length);
 }
 
-// Blocking function that writes a serial character when the UART buffer is not full
+// Function that queues a serial character, blocking only while both buffers are full
 void putcUart0(char c)
 {
-    while (UART0_FR_R & UART_FR_TXFF);               // wait if uart0 tx fifo full
-    UART0_DR_R = c;                                  // write character to fifo
+    while (!tryPutcUart0(c));                        // wait if tx buffers full
 }
 
-// Blocking function that writes a string when the UART buffer is not full
+// Function that queues a string, blocking only while both buffers are full
 void putsUart0(char* str)
 {
-    uint8_t i = 0;
-    while (str[i] != '\0')
-        putcUart0(str[i++]);
+    while (*str != '\0')
+    {
+        str += tryPutsUart0(str);
+    }
+}
+
+// Non-blocking function that reads a character, returns false if none is waiting
+bool tryGetcUart0(char* c)
+{
+    if (rxTail == rxHead)
+    {
+        return false;
+    }
+    *c = rxBuffer[rxTail & (RX_BUFFER_SIZE-1)];
+    rxTail++;
+    return true;
 }
 
 // Blocking function that returns with serial data once the buffer is not empty
 char getcUart0()
 {
-    while (UART0_FR_R & UART_FR_RXFE);               // wait if uart0 rx fifo empty
-    return UART0_DR_R & 0xFF;                        // get character from fifo
+    char c;
+    while (!tryGetcUart0(&c));                       // wait if rx ring empty
+    return c;
 }
 
 // Returns the status of the receive buffer
 bool kbhitUart0()
 {
-    return !(UART0_FR_R & UART_FR_RXFE);
+    return rxTail != rxHead;
+}
+
+// Returns true when nothing is waiting and nothing has arrived for us microseconds
+bool isUart0RxIdle(uint32_t us)
+{
+    return rxTail == rxHead && (UART0_FR_R & UART_FR_RXFE) && (uint32_t)getTimeUs() - rxLastUs >= us;
 }
 
 //-----------------------------------------------------------------------------
-// Parse User Data
+// UART Interrupt
 //-----------------------------------------------------------------------------
 
-void getsUart0(USER_DATA * data)
+void uart0Isr()
 {
-    int count = 0;
-    unsigned char c = 0;
+    uint32_t perfStart = PERF_BEGIN();
 
-    while (count < MAX_CHARS)
+    // Drain the RX FIFO into the ring, counting characters lost to a full ring
+    while (!(UART0_FR_R & UART_FR_RXFE))
     {
-        c = getcUart0();
-        if (c == 127 || c == 8) // if input is backspace, decrement count if count is > 0
+        char c = UART0_DR_R & 0xFF;
+        if ((uint16_t)(rxHead - rxTail) < RX_BUFFER_SIZE)
         {
-            if (count > 0)
-            {
-                count--;
-            }
+            rxBuffer[rxHead & (RX_BUFFER_SIZE-1)] = c;
+            rxHead++;
         }
-
-        else if (c == 10 || c == 13) //if input is CR or LF
-        {
-            data->buffer[count] = '\0';
-            return;
-        }
-
         else
         {
-            if (c >= 32)
-            {
-                data->buffer[count++] = c;
-                if (count >= MAX_CHARS)
-                {
-                    data->buffer[count] = '\0';
-                    return;
-                }
-            }
+            uart0RxOverflows++;
         }
     }
-    return;
-}
 
-void parseFields(USER_DATA * data)
-{
-    int index = 0;
-    int dataIndex = 0;
+    if (UART0_MIS_R & (UART_MIS_RXMIS | UART_MIS_RTMIS))
+    {
+        rxLastUs = (uint32_t)getTimeUs();
+    }
+    UART0_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC;
 
-    data->fieldCount = 0;
+    // Transmit buffer sent, start the other one if the CPU has filled it
+    if (UDMA_CHIS_R & (1 << UART0_TX_DMA_CH))
+    {
+        UDMA_CHIS_R = 1 << UART0_TX_DMA_CH;
+        dmaBusy = false;
+        startTxDma();
+    }
+    PERF_END(PERF_UART, perfStart);
+}
+
+//-----------------------------------------------------------------------------
+// Parse User Data
+//-----------------------------------------------------------------------------
 
-    char previous = 'd';
-    char current = 'x';
+// Non-blocking line editor: consumes whatever characters are waiting and
+// returns true once a complete line is in data->buffer. The partial line is
+// kept in data->buffer and data->lineCount between calls, so the same
+// USER_DATA, zeroed before its first use, must be passed until a line
+// completes.
+bool getsUart0NonBlocking(USER_DATA * data)
+{
+    char received;
 
-    //Loops through buffer until NULL terminator is reached
-    while(data->buffer[index] != NULL)
+    while (tryGetcUart0(&received))
     {
+        unsigned char c = received;
 
-        char c = data->buffer[index];
-
-        //If char is alpha, ('a'-'z') || ('A'-'Z') ==> fieldType = 'a'
-        if( ((c >= 97) && (c <= 122)) || ((c >= 65) &&  (c <= 90)) )
+        if (c == 127 || c == 8) // if input is backspace, decrement count if count is > 0
         {
-            current = 'a';
-            index++;
+            if (data->lineCount > 0)
+            {
+                data->lineCount--;
+            }
         }
 
-        //If char is numeric, ('0'-'9') || '-' || '.' ==> fieldType = 'n'
-        else if ( ((c >= 48) && (c <= 57)) || (c == 45) ||  (c == 46) )
+        else if (c == 10 || c == 13) //if input is CR or LF
         {
-            current = 'n';
-            index++;
+            data->buffer[data->lineCount] = '\0';
+            data->lineCount = 0;
+            return true;
         }
 
-        //Else char is a delimiter ==> fieldType = 'd'
-        //Set previous to d in order to continue through string
-        //replace delimiters with NULL character
         else
         {
-            current = 'd';
-            previous = 'd';
-            data->buffer[index] = NULL;
-            index++;
-        }
-
-        //Occurs when transition from 'd' to 'a' OR 'd' to 'n'
-        if((current != previous) && (previous == 'd'))
-        {
-            //Increment Field Count
-            (data->fieldCount)++;
-
-            //Stores the fieldType of Transition
-            data->fieldType[dataIndex] = current;
-
-            //Stores fieldPosition of Transition and increments dataIndex
-            data->fieldPosition[dataIndex] = (index-1);
-
-            dataIndex++;
-
-            //Updates previous c
-            previous = current;
-
-            //returns if fieldCount Reaches 5
-            if ((data->fieldCount) == MAX_FIELDS) return;
+            if (c >= 32)
+            {
+                data->buffer[data->lineCount++] = c;
+                if (data->lineCount >= MAX_CHARS)
+                {
+                    data->buffer[data->lineCount] = '\0';
+                    data->lineCount = 0;
+                    return true;
+                }
+            }
         }
     }
+    return false;
 }
 
-bool isCommand(USER_DATA* data, const char strCommand[], uint8_t minArguments)
+// Blocking function that returns with a complete line
+void getsUart0(USER_DATA * data)
 {
-    char* field0 = getFieldString(data, 0);
-
-    //Returns True if first field is equal to command AND number of arguments >= # of minimum arguments
-    if ( (!strcmp(field0, strCommand)) && ((data->fieldCount) > minArguments) )
-    {
-        return 1;
-    }
-
-    else return 0;
+    data->lineCount = 0;
+    while (!getsUart0NonBlocking(data));
 }
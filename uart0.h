@@ -26,31 +26,35 @@
 #ifndef UART0_H_
 #define UART0_H_
 
-#define MAX_CHARS 80
-#define MAX_FIELDS 7
+#include "parse.h"
 
-typedef struct _USER_DATA
-{
-    char buffer[MAX_CHARS+1];
-    uint8_t fieldCount;
-    uint8_t fieldPosition[MAX_FIELDS];
-    char fieldType[MAX_FIELDS];
-} USER_DATA;
+#define UART_MAX_BAUD_ERROR_PPM 20000   // 2% combined with the host's error stays within 8N1 tolerance
+
+extern uint32_t uart0RxOverflows;
+extern uint32_t uart0BaudRate;
 
 //-----------------------------------------------------------------------------
 // Subroutines
 //-----------------------------------------------------------------------------
 
 void initUart0();
-void setUart0BaudRate(uint32_t baudRate, uint32_t fcyc);
+int32_t getUart0BaudDivisor(uint32_t baudRate, uint32_t fcyc, uint32_t* divisorTimes64, bool* highSpeed);
+bool setUart0BaudRate(uint32_t baudRate, uint32_t fcyc);
+void flushUart0();
 void putcUart0(char c);
 char getcUart0();
 void putsUart0(char* str);
 char getcUart0();
 bool kbhitUart0();
+bool tryPutcUart0(char c);
+uint16_t tryPutsUart0(const char* str);
+uint16_t tryWriteUart0(const uint8_t* data, uint16_t length);
+bool tryGetcUart0(char* c);
+uint16_t getUart0TxFree();
+bool isUart0RxIdle(uint32_t us);
+bool isUart0TxIdle();
 void getsUart0(USER_DATA * data);
-void parseFields(USER_DATA * data);
-bool isCommand(USER_DATA* data, const char strCommand[], uint8_t minArguments);
+bool getsUart0NonBlocking(USER_DATA * data);
 
 
 #endif
@@ -0,0 +1,216 @@
+// EEPROM Wear Leveling
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+// The configuration words live in logical blocks 0-11. Each logical block
+// can sit in its home block or in one of the spare blocks 13-15 and 28-31;
+// the map in block 12 holds one byte per logical block (0xFF = home), so
+// erased EEPROM needs no migration.
+//
+// Word writes are counted per physical block and a count in units of
+// WEAR_UNIT writes is kept in block 12 after the map. When the block a
+// logical block sits in is WEAR_MARGIN units ahead of the least worn spare,
+// its 16 words are copied to that spare and then the map byte is written;
+// a reset before the map write leaves the old copy in use.
+
+//-----------------------------------------------------------------------------
+// Device includes, defines, and assembler directives
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "wear.h"
+#include "eeprom.h"
+
+#define WEAR_COUNT_ADD      (WEAR_MAP_ADD + 3)
+#define WEAR_SLOTS          20      // blocks 0-15 and 28-31 (slot 12 is the map itself)
+#define WEAR_MARGIN         8
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+
+uint32_t wearMoves = 0;
+
+static const uint8_t spareBlocks[] = { 13, 14, 15, 28, 29, 30, 31 };
+
+#define SPARE_COUNT (sizeof(spareBlocks)/sizeof(spareBlocks[0]))
+
+static uint8_t  blockMap[WEAR_BLOCKS];
+static uint16_t wearUnits[WEAR_SLOTS];
+static uint8_t  wearPending[WEAR_SLOTS];
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+static uint8_t getSlot(uint8_t block)
+{
+    return (block < 16) ? block : block - 12;
+}
+
+static bool isCandidate(uint8_t block)
+{
+    uint8_t i;
+
+    if (block < WEAR_BLOCKS)
+    {
+        return true;
+    }
+    for (i = 0; i < SPARE_COUNT; i++)
+    {
+        if (spareBlocks[i] == block)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isInUse(uint8_t block)
+{
+    uint8_t i;
+
+    for (i = 0; i < WEAR_BLOCKS; i++)
+    {
+        if (blockMap[i] == block)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void saveMap(uint8_t logical)
+{
+    uint8_t first = logical & ~3;
+    uint32_t word = 0;
+    uint8_t i;
+
+    for (i = 0; i < 4 && first + i < WEAR_BLOCKS; i++)
+    {
+        uint8_t byte = (blockMap[first + i] == first + i) ? 0xFF : blockMap[first + i];
+        word |= (uint32_t)byte << (8*i);
+    }
+    for (; i < 4; i++)
+    {
+        word |= (uint32_t)0xFF << (8*i);
+    }
+    writeEeprom(WEAR_MAP_ADD + logical/4, word);
+}
+
+static void saveWearCount(uint8_t slot)
+{
+    uint8_t even = slot & ~1;
+    writeEeprom(WEAR_COUNT_ADD + slot/2, wearUnits[even] | ((uint32_t)wearUnits[even + 1] << 16));
+}
+
+void initWear(void)
+{
+    uint32_t words[3 + WEAR_SLOTS/2];
+    uint8_t i;
+
+    readEepromBlock(WEAR_MAP_ADD, words, 3 + WEAR_SLOTS/2);
+
+    for (i = 0; i < WEAR_BLOCKS; i++)
+    {
+        blockMap[i] = 0xFF;
+    }
+    for (i = 0; i < WEAR_BLOCKS; i++)
+    {
+        uint8_t block = words[i/4] >> (8*(i % 4));
+        blockMap[i] = (block != 0xFF && isCandidate(block) && !isInUse(block)) ? block : i;
+    }
+
+    for (i = 0; i < WEAR_SLOTS; i++)
+    {
+        uint16_t units = words[3 + i/2] >> (16*(i % 2));
+        wearUnits[i] = (units == 0xFFFF) ? 0 : units;
+        wearPending[i] = 0;
+    }
+}
+
+// Translates a logical word address to the block it currently lives in
+uint16_t getWearAddress(uint16_t add)
+{
+    if (add >= WEAR_BLOCKS*16)
+    {
+        return add;
+    }
+    return blockMap[add >> 4]*16 + (add & 0xF);
+}
+
+uint8_t getWearBlock(uint8_t logical)
+{
+    return blockMap[logical];
+}
+
+// Returns the number of writes seen by a physical block (in WEAR_UNIT steps plus this session)
+uint32_t getWearCount(uint8_t block)
+{
+    uint8_t slot = getSlot(block);
+    return (uint32_t)wearUnits[slot]*WEAR_UNIT + wearPending[slot];
+}
+
+static uint8_t getLeastWornSpare(void)
+{
+    uint8_t best = 0xFF;
+    uint8_t i;
+
+    for (i = 0; i < WEAR_BLOCKS + SPARE_COUNT; i++)
+    {
+        uint8_t block = (i < WEAR_BLOCKS) ? i : spareBlocks[i - WEAR_BLOCKS];
+        if (!isInUse(block) && (best == 0xFF || wearUnits[getSlot(block)] < wearUnits[getSlot(best)]))
+        {
+            best = block;
+        }
+    }
+    return best;
+}
+
+static void relocateBlock(uint8_t logical, uint8_t spare)
+{
+    uint32_t words[16];
+
+    readEepromBlock(blockMap[logical]*16, words, 16);
+    writeEepromBlock(spare*16, words, 16);
+    wearPending[getSlot(spare)] += 16;
+
+    blockMap[logical] = spare;
+    saveMap(logical);
+    wearMoves++;
+}
+
+// Called after each write to a configuration word
+void noteWearWrite(uint16_t add)
+{
+    uint8_t logical = add >> 4;
+    uint8_t slot;
+    uint8_t spare;
+
+    if (add >= WEAR_BLOCKS*16)
+    {
+        return;
+    }
+
+    slot = getSlot(blockMap[logical]);
+    if (++wearPending[slot] < WEAR_UNIT)
+    {
+        return;
+    }
+    wearPending[slot] -= WEAR_UNIT;
+    wearUnits[slot]++;
+    saveWearCount(slot);
+
+    spare = getLeastWornSpare();
+    if (spare != 0xFF && wearUnits[slot] >= wearUnits[getSlot(spare)] + WEAR_MARGIN)
+    {
+        relocateBlock(logical, spare);
+    }
+}
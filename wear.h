@@ -0,0 +1,32 @@
+// EEPROM Wear Leveling
+// Ethan Sprinkle
+
+//-----------------------------------------------------------------------------
+// Hardware Target
+//-----------------------------------------------------------------------------
+
+// Target uC:       TM4C123GH6PM
+// System Clock:    -
+
+#ifndef WEAR_H_
+#define WEAR_H_
+
+#include <stdint.h>
+
+#define WEAR_BLOCKS         12      // logical blocks 0-11 hold the configuration words
+#define WEAR_MAP_ADD        192     // block 12: 3 words of map bytes, then wear counts
+#define WEAR_UNIT           64      // word writes per persisted wear count
+
+extern uint32_t wearMoves;
+
+//-----------------------------------------------------------------------------
+// Subroutines
+//-----------------------------------------------------------------------------
+
+void initWear(void);
+uint16_t getWearAddress(uint16_t add);
+uint8_t getWearBlock(uint8_t logical);
+uint32_t getWearCount(uint8_t block);
+void noteWearWrite(uint16_t add);
+
+#endif